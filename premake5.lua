@@ -56,6 +56,18 @@ filter "options:time-trace"
 	buildoptions {"-ftime-trace"}
 	linkoptions {"-ftime-trace"}
 
+newoption {
+	trigger = "float-rasterizer",
+	description = "Interpolate triangle attributes in float instead of fixed point"
+}
+filter "not options:float-rasterizer"
+	defines "USE_FIXED_POINT"
+
+newoption {
+	trigger = "headless",
+	description = "Build headless frontend (no SDL/OpenGL, for benchmarks and regression runs)"
+}
+
 
 filter {}
 	language "c++"
@@ -231,9 +243,13 @@ project "avocado"
 	filter "options:headless"
 		files { 
 			"src/platform/headless/**.cpp",
-			"src/platform/headless/**.h"
+			"src/platform/headless/**.h",
+			"src/platform/null/**.cpp",
 		}
 
+	filter {"system:linux", "options:headless"}
+		links { "pthread" }
+
 	filter {"system:windows", "not options:headless"}
 		includedirs { 
 			"externals/SDL2/include",
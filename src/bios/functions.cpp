@@ -121,7 +121,7 @@ bool unresolvedException(System* sys) {
     fmt::print(RED, "This is most likely bug in Avocado, please report it.\n");
     fmt::print(RED | BOLD, "Emulation stopped.\n");
 
-    toast("Emulation stopeed, see console for logs");
+    sys->toast("Emulation stopeed, see console for logs");
     sys->state = System::State::halted;
     return false;
 }
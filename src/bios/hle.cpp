@@ -0,0 +1,338 @@
+#include "hle.h"
+#include <algorithm>
+#include <cstring>
+#include "system.h"
+
+// Return values and argument checks follow retail BIOS (SCPH1001),
+// temporary registers clobbered by BIOS code are left intact.
+namespace bios::hle {
+
+namespace {
+// Function tables copied by BIOS to kernel RAM
+const uint32_t TABLE_ADDRESS[] = {0x200, 0x874, 0x674};
+
+// Longer operations are left to BIOS (it would run over the whole address space)
+const uint32_t MAX_LENGTH = System::RAM_SIZE;
+
+// Kernel variable holding rand() state
+const uint32_t RAND_SEED = 0x9010;
+
+// Heap chunk header: payload size | FREE
+const uint32_t FREE = 1;
+
+uint32_t arg(System* sys, int n) { return sys->cpu->reg[4 + n]; }
+void setResult(System* sys, uint32_t value) { sys->cpu->reg[2] = value; }
+uint32_t align4(uint32_t value) { return (value + 3) & ~3; }
+
+// Bytes accessible at address without leaving RAM (single mirror) or scratchpad, host pointer to them in *data.
+// Anything else (IO, unmapped addresses raising bus error, isolated cache) is left to BIOS.
+uint32_t memoryAt(System* sys, uint32_t address, uint8_t** data) {
+    if (sys->cpu->cop0.status.isolateCache) return 0;
+
+    uint32_t addr = address & 0x1fff'ffff;
+    if (addr < System::RAM_BASE + System::RAM_SIZE * 4) {
+        uint32_t offset = (addr - System::RAM_BASE) & (System::RAM_SIZE - 1);
+        *data = sys->ram.data() + offset;
+        return System::RAM_SIZE - offset;
+    }
+    if (addr >= System::SCRATCHPAD_BASE && addr < System::SCRATCHPAD_BASE + System::SCRATCHPAD_SIZE) {
+        *data = sys->scratchpad.data() + (addr - System::SCRATCHPAD_BASE);
+        return System::SCRATCHPAD_BASE + System::SCRATCHPAD_SIZE - addr;
+    }
+    return 0;
+}
+
+// Host pointer to [address, address + length) or nullptr if routine has to fall back to BIOS
+uint8_t* memory(System* sys, uint32_t address, uint32_t length) {
+    uint8_t* data = nullptr;
+    if (length == 0 || memoryAt(sys, address, &data) < length) return nullptr;
+    return data;
+}
+
+// Range returned by memory() was modified - compiled code on touched RAM pages is dropped
+void written(System* sys, uint32_t address, uint32_t length) {
+    uint32_t addr = address & 0x1fff'ffff;
+    if (addr < System::RAM_BASE + System::RAM_SIZE * 4) sys->ramWritten((addr - System::RAM_BASE) & (System::RAM_SIZE - 1), length);
+}
+
+// Forward byte by byte copy as in BIOS, overlapping destination after source repeats the pattern
+void copy(uint8_t* dst, const uint8_t* src, uint32_t length) {
+    if (dst <= src || dst >= src + length) {
+        std::memmove(dst, src, length);
+    } else {
+        for (uint32_t i = 0; i < length; i++) dst[i] = src[i];
+    }
+}
+
+// Returns length of NUL terminated string or MAX_LENGTH if there is no terminator in accessible memory
+uint32_t stringLength(System* sys, uint32_t address) {
+    uint8_t* data = nullptr;
+    uint32_t size = std::min(memoryAt(sys, address, &data), MAX_LENGTH);
+    if (size == 0) return MAX_LENGTH;
+    auto end = static_cast<const uint8_t*>(std::memchr(data, 0, size));
+    return end != nullptr ? (uint32_t)(end - data) : MAX_LENGTH;
+}
+
+bool memcpy(System* sys) {
+    uint32_t dst = arg(sys, 0), src = arg(sys, 1), length = arg(sys, 2);
+    if (length > 0x7fffffff || dst == 0) {
+        setResult(sys, dst);
+        return true;
+    }
+    if (length > MAX_LENGTH) return false;
+
+    if (length != 0) {
+        uint8_t* to = memory(sys, dst, length);
+        uint8_t* from = memory(sys, src, length);
+        if (to == nullptr || from == nullptr) return false;
+        copy(to, from, length);
+        written(sys, dst, length);
+    }
+    setResult(sys, dst);
+    return true;
+}
+
+bool memset(System* sys) {
+    uint32_t dst = arg(sys, 0), length = arg(sys, 2);
+    if (length > 0x7fffffff || dst == 0) {
+        setResult(sys, 0);
+        return true;
+    }
+    if (length > MAX_LENGTH) return false;
+
+    if (length != 0) {
+        uint8_t* to = memory(sys, dst, length);
+        if (to == nullptr) return false;
+        std::memset(to, (uint8_t)arg(sys, 1), length);
+        written(sys, dst, length);
+    }
+    setResult(sys, dst);
+    return true;
+}
+
+bool bzero(System* sys) {
+    uint32_t dst = arg(sys, 0), length = arg(sys, 1);
+    if (length > 0x7fffffff || length == 0 || dst == 0) {
+        setResult(sys, 0);
+        return true;
+    }
+    if (length > MAX_LENGTH) return false;
+
+    uint8_t* to = memory(sys, dst, length);
+    if (to == nullptr) return false;
+    std::memset(to, 0, length);
+    written(sys, dst, length);
+    setResult(sys, dst);
+    return true;
+}
+
+bool strcmp(System* sys) {
+    uint32_t str1 = arg(sys, 0), str2 = arg(sys, 1);
+    if (str1 == 0 || str2 == 0) {
+        setResult(sys, str1 == str2 ? 0 : (str1 == 0 ? -1 : 1));
+        return true;
+    }
+
+    uint8_t *data1 = nullptr, *data2 = nullptr;
+    uint32_t size = std::min({memoryAt(sys, str1, &data1), memoryAt(sys, str2, &data2), MAX_LENGTH});
+    for (uint32_t i = 0; i < size; i++) {
+        int8_t c1 = data1[i];
+        int8_t c2 = data2[i];
+        if (c1 != c2) {
+            setResult(sys, c1 - c2);
+            return true;
+        }
+        if (c1 == 0) {
+            setResult(sys, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool strlen(System* sys) {
+    uint32_t src = arg(sys, 0);
+    if (src == 0) {
+        setResult(sys, 0);
+        return true;
+    }
+
+    uint32_t length = stringLength(sys, src);
+    if (length == MAX_LENGTH) return false;
+    setResult(sys, length);
+    return true;
+}
+
+bool strcpy(System* sys) {
+    uint32_t dst = arg(sys, 0), src = arg(sys, 1);
+    if (dst == 0 || src == 0) {
+        setResult(sys, 0);
+        return true;
+    }
+
+    uint32_t length = stringLength(sys, src);
+    if (length == MAX_LENGTH) return false;
+    uint8_t* to = memory(sys, dst, length + 1);
+    if (to == nullptr) return false;
+    copy(to, memory(sys, src, length + 1), length + 1);
+    written(sys, dst, length + 1);
+    setResult(sys, dst);
+    return true;
+}
+
+bool rand(System* sys) {
+    uint32_t seed = sys->readMemory32(RAND_SEED) * 1103515245 + 12345;
+    sys->writeMemory32(RAND_SEED, seed);
+    setResult(sys, (seed >> 16) & 0x7fff);
+    return true;
+}
+
+bool srand(System* sys) {
+    sys->writeMemory32(RAND_SEED, arg(sys, 0));
+    return true;
+}
+
+// First fit allocator, adjacent free chunks are merged while searching
+uint32_t allocate(System* sys, uint32_t size) {
+    auto& heap = sys->hleHeap;
+    size = std::max<uint32_t>(align4(size), 4);
+
+    for (uint32_t chunk = heap.start; chunk + 4 <= heap.end;) {
+        uint32_t header = sys->readMemory32(chunk);
+        uint32_t length = header & ~3;
+
+        if (header & FREE) {
+            for (uint32_t next = chunk + 4 + length; next + 4 <= heap.end; next = chunk + 4 + length) {
+                uint32_t nextHeader = sys->readMemory32(next);
+                if (!(nextHeader & FREE)) break;
+                length += 4 + (nextHeader & ~3);
+            }
+
+            if (length >= size) {
+                // Split if remainder can hold header and some data
+                if (length - size >= 8) {
+                    sys->writeMemory32(chunk + 4 + size, (length - size - 4) | FREE);
+                    length = size;
+                }
+                sys->writeMemory32(chunk, length);
+                return chunk + 4;
+            }
+            sys->writeMemory32(chunk, length | FREE);
+        }
+        chunk += 4 + length;
+    }
+    return 0;
+}
+
+void release(System* sys, uint32_t ptr) {
+    auto& heap = sys->hleHeap;
+    if (ptr < heap.start + 4 || ptr >= heap.end || (ptr & 3) != 0) return;
+    sys->writeMemory32(ptr - 4, sys->readMemory32(ptr - 4) | FREE);
+}
+
+bool initHeap(System* sys) {
+    uint32_t address = arg(sys, 0), size = arg(sys, 1);
+    uint32_t start = align4(address);
+    uint32_t end = (address + size) & ~3;
+
+    auto& heap = sys->hleHeap;
+    if (end < start + 8) {
+        heap = Heap();
+        return true;
+    }
+    // Chunks are accessed directly, heap outside RAM is left to BIOS
+    if (memory(sys, start, end - start) == nullptr) return false;
+
+    heap.start = start;
+    heap.end = end;
+    sys->writeMemory32(start, (end - start - 4) | FREE);
+    return true;
+}
+
+bool malloc(System* sys) {
+    if (sys->hleHeap.end == 0) return false;
+    setResult(sys, allocate(sys, arg(sys, 0)));
+    return true;
+}
+
+bool free(System* sys) {
+    if (sys->hleHeap.end == 0) return false;
+    release(sys, arg(sys, 0));
+    return true;
+}
+
+bool calloc(System* sys) {
+    if (sys->hleHeap.end == 0) return false;
+    uint32_t size = arg(sys, 0) * arg(sys, 1);
+    uint32_t ptr = allocate(sys, size);
+    if (ptr != 0 && size != 0) {
+        std::memset(memory(sys, ptr, size), 0, size);
+        written(sys, ptr, size);
+    }
+    setResult(sys, ptr);
+    return true;
+}
+
+bool realloc(System* sys) {
+    if (sys->hleHeap.end == 0) return false;
+    uint32_t ptr = arg(sys, 0), size = arg(sys, 1);
+    if (ptr == 0) {
+        setResult(sys, allocate(sys, size));
+        return true;
+    }
+    if (size == 0) {
+        release(sys, ptr);
+        setResult(sys, 0);
+        return true;
+    }
+
+    // Pointer (and its chunk header) not coming from heap could be anywhere
+    auto& heap = sys->hleHeap;
+    if (ptr < heap.start + 4 || ptr >= heap.end) return false;
+    uint32_t length = std::min(sys->readMemory32(ptr - 4) & ~3, size);
+    uint8_t* from = memory(sys, ptr, length);
+    if (length != 0 && from == nullptr) return false;
+
+    uint32_t newPtr = allocate(sys, size);
+    if (newPtr != 0) {
+        if (length != 0) {
+            copy(memory(sys, newPtr, length), from, length);
+            written(sys, newPtr, length);
+        }
+        release(sys, ptr);
+    }
+    setResult(sys, newPtr);
+    return true;
+}
+}  // namespace
+
+const std::vector<Routine> routines = {
+    {0, 0x17, "strcmp", strcmp},      //
+    {0, 0x19, "strcpy", strcpy},      //
+    {0, 0x1B, "strlen", strlen},      //
+    {0, 0x28, "bzero", bzero},        //
+    {0, 0x2A, "memcpy", memcpy},      //
+    {0, 0x2B, "memset", memset},      //
+    {0, 0x2F, "rand", rand},          //
+    {0, 0x30, "rand", srand},         //
+    {0, 0x33, "malloc", malloc},      //
+    {0, 0x34, "malloc", free},        //
+    {0, 0x37, "malloc", calloc},      //
+    {0, 0x38, "malloc", realloc},     //
+    {0, 0x39, "malloc", initHeap},    //
+};
+
+std::vector<std::string> options() {
+    std::vector<std::string> names;
+    for (const auto& routine : routines) {
+        if (std::find(names.begin(), names.end(), routine.option) == names.end()) names.push_back(routine.option);
+    }
+    return names;
+}
+
+bool isBiosEntry(System* sys, const Routine& routine) {
+    uint32_t entry = sys->readMemory32(TABLE_ADDRESS[routine.table] + routine.number * 4) & 0x1fff'ffff;
+    return entry >= System::BIOS_BASE && entry < System::BIOS_BASE + System::BIOS_SIZE;
+}
+
+};  // namespace bios::hle
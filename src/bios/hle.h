@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct System;
+
+/*
+Native (HLE) implementations of hot BIOS library routines.
+Routine replaces BIOS code at A0/B0/C0 entry - it reads arguments from a0-a3,
+operates on guest memory, sets v0 and returns to $ra.
+Each routine is opt-in (see avocado_config_t::options.emulator.hle) and validated against
+the real BIOS by tests/unit/bios/hle.cpp.
+*/
+namespace bios::hle {
+
+struct Routine {
+    int table;           // 0 - A0, 1 - B0, 2 - C0
+    uint8_t number;      // Function number (t1)
+    const char* option;  // Config key, routines sharing guest state share it
+    // Returns false if BIOS implementation has to be executed instead
+    bool (*handler)(System* sys);
+};
+
+// Heap created by HLE InitHeap, kept outside guest memory
+struct Heap {
+    uint32_t start = 0;
+    uint32_t end = 0;  // 0 - not initialized, malloc family falls back to BIOS
+
+    template <class Archive>
+    void serialize(Archive& ar) {
+        ar(start, end);
+    }
+};
+
+extern const std::vector<Routine> routines;
+
+// Unique config keys, in table order
+std::vector<std::string> options();
+
+// Routine is used only if guest didn't patch the function table entry
+bool isBiosEntry(System* sys, const Routine& routine);
+
+};  // namespace bios::hle
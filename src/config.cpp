@@ -169,6 +169,7 @@ KeyBindings keyboard() {
         {"single_step", "keyboard|F8"},
         {"toggle_pause", "keyboard|Space"},
         {"toggle_framelimit", "keyboard|Tab"},
+        {"toggle_turbo", "keyboard|`"},
         {"rewind_state", "keyboard|Backspace"},
         {"toggle_fullscreen", "keyboard|F4"}
     };
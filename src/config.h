@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include "cpu/cpu_mode.h"
 #include "device/controller/controller_type.h"
 #include "device/gpu/rendering_mode.h"
 #include "utils/event.h"
@@ -64,6 +65,9 @@ struct avocado_config_t {
             bool vsync = false;
             bool forceNtsc = false;
             bool nativeTextureFormat = true;
+            int frameSkip = 0;        // Frames skipped after each presented one
+            int rendererThreads = 0;  // Software rasterizer threads, 0 - draw on emulation thread
+            bool gpuThread = false;   // Execute GP0 commands on separate thread
         } graphics;
 
         struct {
@@ -73,6 +77,13 @@ struct avocado_config_t {
         struct {
             bool preserveState = true;
             bool timeTravel = false;
+            CpuMode cpuMode = CpuMode::interpreter;
+            bool fastmem = false;
+            std::unordered_map<std::string, bool> hle;  // Native BIOS routines, key - bios::hle::Routine::option
+            struct {
+                int speed = 4;      // Multiplier of real time speed, 0 - unlimited
+                int frameSkip = 3;  // Used instead of graphics.frameSkip while turbo is on
+            } turbo;
         } emulator;
 
     } options;
@@ -0,0 +1,138 @@
+#include "block_cache.h"
+#include "cpu/instructions.h"
+#include "system.h"
+
+namespace mips {
+namespace {
+bool isBiosHook(uint32_t address) { return address == 0xa0 || address == 0xb0 || address == 0xc0; }
+
+// Instructions after which execution might not continue sequentially
+bool endsBlock(Opcode i) {
+    if (i.op == 0) {
+        return i.fun == 8 || i.fun == 9 || i.fun == 12 || i.fun == 13;  // jr, jalr, syscall, break
+    }
+    return i.op >= 1 && i.op <= 7;  // bcondz, j, jal, beq, bne, blez, bgtz
+}
+
+bool hasDelaySlot(Opcode i) {
+    if (i.op == 0) return i.fun == 8 || i.fun == 9;
+    return i.op >= 1 && i.op <= 7;
+}
+
+// Instructions which only modify CPU registers
+bool isSideEffectFree(Opcode i) {
+    if (i.op == 0) {
+        return i.fun <= 7 || (i.fun >= 16 && i.fun <= 27) || (i.fun >= 32 && i.fun <= 43);  // shifts, hi/lo, mult/div, ALU
+    }
+    if (i.op >= 8 && i.op <= 15) return true;  // ALU with immediate
+    return i.op >= 32 && i.op <= 38;           // Loads
+}
+
+// Short loop polling memory or I/O - nothing but loaded values can change its state
+bool isIdleLoop(const std::vector<CachedInstruction>& instructions, uint32_t address) {
+    const size_t MAX_LENGTH = 16;
+    size_t length = instructions.size();
+    if (length < 2 || length > MAX_LENGTH) return false;
+
+    Opcode branch = instructions[length - 2].opcode;
+    uint32_t branchPc = address + (uint32_t)(length - 2) * 4;
+    uint32_t target;
+    if (branch.op == 2) {  // j
+        target = ((branchPc + 4) & 0xf000'0000) | (branch.target << 2);
+    } else if (branch.op == 1 || (branch.op >= 4 && branch.op <= 7)) {  // bcondz, beq, bne, blez, bgtz
+        if (branch.op == 1 && (branch.rt & 0x1e) == 0x10) return false;  // bltzal, bgezal
+        target = branchPc + 4 + (branch.offset * 4);
+    } else {
+        return false;
+    }
+    if (target != address) return false;
+
+    for (size_t n = 0; n < length; n++) {
+        if (n != length - 2 && !isSideEffectFree(instructions[n].opcode)) return false;
+    }
+    return true;
+}
+}  // namespace
+
+BlockCache::BlockCache(System* sys) : sys(sys) { clear(); }
+
+static_assert(BlockCache::PAGE_SIZE == System::PAGE_SIZE, "Block cache page must match memory page");
+
+void BlockCache::clear() {
+    for (uint32_t page = 0; page < codePages.size(); page++) {
+        if (codePages[page]) sys->protectRamPage(page, false);
+    }
+    for (auto& block : ramBlocks) {
+        if (block) retired.push_back(std::move(block));
+    }
+    for (auto& block : biosBlocks) {
+        if (block) retired.push_back(std::move(block));
+    }
+    ramBlocks.resize(System::RAM_SIZE / 4);
+    biosBlocks.resize(System::BIOS_SIZE / 4);
+    codePages.assign(System::RAM_SIZE / PAGE_SIZE, 0);
+    invalidated = true;
+}
+
+Block* BlockCache::get(uint32_t address) {
+    retired.clear();
+    invalidated = false;
+
+    uint32_t phys = address & 0x1fff'ffff;
+    std::unique_ptr<Block>* slot;
+    if (phys < System::RAM_SIZE * 4) {
+        slot = &ramBlocks[(phys & (System::RAM_SIZE - 1)) / 4];
+    } else if (phys >= System::BIOS_BASE && phys < System::BIOS_BASE + System::BIOS_SIZE) {
+        slot = &biosBlocks[(phys - System::BIOS_BASE) / 4];
+    } else {
+        return nullptr;
+    }
+
+    if (likely(*slot)) return slot->get();
+
+    *slot = compile(address);
+    if (phys < System::RAM_SIZE * 4) {
+        // Writes to pages with code must go through slow path to invalidate blocks
+        uint32_t page = (phys & (System::RAM_SIZE - 1)) / PAGE_SIZE;
+        if (!codePages[page]) sys->protectRamPage(page, true);
+        codePages[page] = 1;
+    }
+    return slot->get();
+}
+
+std::unique_ptr<Block> BlockCache::compile(uint32_t address) {
+    auto block = std::make_unique<Block>();
+    block->address = address & 0x1fff'ffff;
+    block->biosHook = isBiosHook(block->address);
+
+    bool delaySlot = false;
+    for (uint32_t pc = address;;) {
+        Opcode i(sys->readMemory32(pc));
+        auto handler = i.op == 0 ? instructions::SpecialTable[i.fun].instruction : instructions::OpcodeTable[i.op].instruction;
+        block->instructions.push_back({handler, i});
+        pc += 4;
+
+        if (delaySlot) break;
+        if (endsBlock(i)) {
+            if (!hasDelaySlot(i)) break;
+            delaySlot = true;
+        }
+
+        if ((pc % PAGE_SIZE) == 0) break;
+        if (isBiosHook(pc & 0x1fff'ffff)) break;
+    }
+    block->idleLoop = isIdleLoop(block->instructions, address);
+
+    return block;
+}
+
+void BlockCache::invalidatePage(uint32_t page) {
+    const uint32_t blocksPerPage = PAGE_SIZE / 4;
+    for (uint32_t i = page * blocksPerPage; i < (page + 1) * blocksPerPage; i++) {
+        if (ramBlocks[i]) retired.push_back(std::move(ramBlocks[i]));
+    }
+    codePages[page] = 0;
+    sys->protectRamPage(page, false);
+    invalidated = true;
+}
+};  // namespace mips
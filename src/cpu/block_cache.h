@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "opcode.h"
+#include "utils/macros.h"
+
+struct System;
+
+namespace mips {
+struct CPU;
+
+// Instruction decoded once, with its handler resolved from Opcode/Special tables
+struct CachedInstruction {
+    void (*handler)(CPU*, Opcode);
+    Opcode opcode;
+};
+
+// Instruction predecoded for threaded interpreter, label points to its handler inside CPU::runThreaded
+struct ThreadedInstruction {
+    const void* label;
+    void (*handler)(CPU*, Opcode);  // Interpreter handler for instructions without specialized one
+    Opcode opcode;
+    uint32_t imm;  // Extended immediate, shift amount or branch target
+    uint8_t rs, rt, rd;
+};
+
+// Straight-line run of instructions ending with branch + delay slot (or page boundary)
+struct Block {
+    uint32_t address;  // Physical address
+    bool biosHook;     // Starts at A0/B0/C0 BIOS function vector
+    bool idleLoop;     // Branches back to itself without stores or COP access (polling loop)
+    std::vector<CachedInstruction> instructions;
+
+    // Native code from recompiler or threaded handlers, valid only when entered at codeAddress
+    int (*code)(CPU*) = nullptr;
+    std::vector<ThreadedInstruction> threaded;
+    uint32_t codeAddress = 0;
+    bool uncompilable = false;
+};
+
+/*
+Cache of decoded basic blocks for the cached interpreter.
+Only code in RAM and BIOS is cached, everything else is interpreted.
+Blocks never cross 4KB page boundary - write to RAM page containing code
+drops all blocks on that page.
+*/
+class BlockCache {
+   public:
+    static const uint32_t PAGE_SIZE = 4096;
+
+   private:
+    System* sys;
+    std::vector<std::unique_ptr<Block>> ramBlocks;
+    std::vector<std::unique_ptr<Block>> biosBlocks;
+    std::vector<uint8_t> codePages;               // RAM pages with at least one compiled block
+    std::vector<std::unique_ptr<Block>> retired;  // Invalidated blocks, freed on next lookup (might be still executing)
+
+    std::unique_ptr<Block> compile(uint32_t address);
+    void invalidatePage(uint32_t page);
+
+   public:
+    bool invalidated = false;  // Set when any block was dropped, current block must not be continued
+
+    BlockCache(System* sys);
+
+    // Returns nullptr if address is not cacheable
+    Block* get(uint32_t address);
+    void clear();
+
+    // Called on every write to RAM, address already masked to RAM_SIZE
+    INLINE void invalidate(uint32_t address) {
+        uint32_t page = address / PAGE_SIZE;
+        if (likely(!codePages[page])) return;
+        invalidatePage(page);
+    }
+};
+};  // namespace mips
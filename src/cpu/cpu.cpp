@@ -1,10 +1,11 @@
 #include "cpu.h"
+#include <algorithm>
 #include "bios/functions.h"
 #include "cpu/instructions.h"
 #include "system.h"
 
 namespace mips {
-CPU::CPU(System* sys) : sys(sys), _opcode(0) {
+CPU::CPU(System* sys) : sys(sys), _opcode(0), blockCache(sys) {
     setPC(0xBFC00000);
     inBranchDelay = false;
     icacheEnabled = false;
@@ -14,14 +15,16 @@ CPU::CPU(System* sys) : sys(sys), _opcode(0) {
 
     for (auto& slot : slots) slot = {DUMMY_REG, 0};
     for (auto& line : icache) line = {0, 0};
-}
+    updateHookPages();
+
+    setMode(sys->config.options.emulator.cpuMode);
 
-INLINE void CPU::moveLoadDelaySlots() {
-    reg[slots[0].reg] = slots[0].data;
-    slots[0] = slots[1];
-    slots[1].reg = DUMMY_REG;  // invalidate
+    busToken = sys->bus->listen<Event::Config::Gte>([this](auto) { gte.reload(this->sys->config); });
+    gte.reload(sys->config);
 }
 
+CPU::~CPU() { sys->bus->unlistenAll(busToken); }
+
 void CPU::saveStateForException() {
     exceptionPC = PC;
     exceptionIsInBranchDelay = inBranchDelay;
@@ -76,38 +79,239 @@ INLINE uint32_t CPU::fetchInstruction(uint32_t address) {
     return data;
 }
 
+INLINE void CPU::execute(Opcode opcode) {
+    _opcode = opcode;
+    const auto& op = instructions::OpcodeTable[_opcode.op];
+
+    setPC(nextPC);
+
+    op.instruction(this, _opcode);
+
+    moveLoadDelaySlots();
+
+    sys->cycles++;
+}
+
+INLINE void CPU::fetchAndExecute() { execute(Opcode(fetchInstruction(PC))); }
+
 bool CPU::executeInstructions(int count) {
+    switch (mode) {
+        case CpuMode::cachedInterpreter: return executeBlocks(count);
+        case CpuMode::threadedInterpreter: return executeThreaded(count);
+        case CpuMode::jit: return executeJit(count);
+        default: return interpret(count);
+    }
+}
+
+// Page of PC is looked up in hookPages only when execution leaves last page without hooks
+INLINE bool CPU::checkHooks() {
+    if (likely(PC / BlockCache::PAGE_SIZE == unhookedPage)) return false;
+    if (isHooked(PC)) return true;
+
+    unhookedPage = PC / BlockCache::PAGE_SIZE;
+    return false;
+}
+
+bool CPU::interpret(int count) {
     for (int i = 0; i < count; i++) {
-        // HACK: BIOS hooks
-        uint32_t maskedPc = PC & 0x1fff'ffff;
-        if (maskedPc == 0xa0 || maskedPc == 0xb0 || maskedPc == 0xc0) sys->handleBiosFunction();
+        bool hooked = checkHooks();
+        if (unlikely(hooked)) {
+            uint32_t maskedPc = PC & 0x1fff'ffff;
+            if (maskedPc == 0xa0 || maskedPc == 0xb0 || maskedPc == 0xc0) sys->handleBiosFunction();
+        }
 
         saveStateForException();
-        checkForInterrupts();
-        if (unlikely(breakpointsEnabled)) {
-            handleHardwareBreakpoints();
-            if (handleSoftwareBreakpoints()) return false;
+        Opcode opcode(fetchInstruction(PC));
+        if (unlikely(interruptPending || hooked)) {
+            uint32_t pc = PC;
+            checkForInterrupts(opcode);
+            if (hooked && breakpointsEnabled) {
+                handleHardwareBreakpoints();
+                if (handleSoftwareBreakpoints()) return false;
+            }
+            // Interrupt or breakpoint - first handler instruction is executed in the same step
+            if (PC != pc) opcode = Opcode(fetchInstruction(PC));
+        }
+
+        execute(opcode);
+        if (sys->state != System::State::run) return false;
+        if (unlikely(sys->scheduler->cpuShouldYield)) break;
+    }
+    return true;
+}
+
+bool CPU::executeBlocks(int count) {
+    idleLoop.valid = false;
+    for (int i = 0; i < count;) {
+        Block* block = blockCache.get(PC);
+        if (unlikely(block == nullptr)) {
+            // Code outside of RAM and BIOS
+            idleLoop.valid = false;
+            if (!interpret(1)) return false;
+            i++;
+            continue;
         }
 
-        _opcode = Opcode(fetchInstruction(PC));
-        const auto& op = instructions::OpcodeTable[_opcode.op];
+        // Native BIOS routine returned to the caller - lookup block at new PC
+        if (block->biosHook && sys->handleBiosFunction()) continue;
+        if (unlikely(block->idleLoop)) {
+            skipIdleLoop(i, count, (int)block->instructions.size());
+            if (i >= count) break;
+        } else {
+            idleLoop.valid = false;
+        }
+        if (!executeBlock(block, i, count)) return false;
+        if (unlikely(sys->scheduler->cpuShouldYield)) break;
+    }
+    return true;
+}
+
+bool CPU::executeBlock(Block* block, int& i, int count) {
+    uint32_t pc = PC;
+    bool breakpoints = unlikely(breakpointsEnabled) && isHooked(pc);  // Blocks never cross page boundary
+    for (const auto& instruction : block->instructions) {
+        // Exception, BIOS hook or branch in delay slot changed the flow - lookup block at new PC
+        if (unlikely(PC != pc)) break;
+
+        saveStateForException();
+        if (unlikely(interruptPending || breakpoints)) {
+            checkForInterrupts(instruction.opcode);
+            if (breakpoints) {
+                handleHardwareBreakpoints();
+                if (handleSoftwareBreakpoints()) return false;
+            }
+
+            // Interrupt or breakpoint - first handler instruction is executed in the same step, as in interpreter
+            if (PC != pc) {
+                fetchAndExecute();
+                if (sys->state != System::State::run) return false;
+                i++;
+                break;
+            }
+        }
+
+        _opcode = instruction.opcode;
 
         setPC(nextPC);
 
-        op.instruction(this, _opcode);
+        instruction.handler(this, _opcode);
 
         moveLoadDelaySlots();
 
         sys->cycles++;
         if (sys->state != System::State::run) return false;
+        if (++i >= count) break;
+
+        // Self-modifying code
+        if (unlikely(blockCache.invalidated)) break;
+        pc += 4;
+    }
+    return true;
+}
+
+bool CPU::executeJit(int count) {
+    idleLoop.valid = false;
+    for (int i = 0; i < count;) {
+        Block* block = blockCache.get(PC);
+        if (unlikely(block == nullptr)) {
+            idleLoop.valid = false;
+            if (!interpret(1)) return false;
+            i++;
+            continue;
+        }
+
+        // Native BIOS routine returned to the caller - lookup block at new PC
+        if (block->biosHook && sys->handleBiosFunction()) continue;
+        if (unlikely(block->idleLoop)) {
+            skipIdleLoop(i, count, (int)block->instructions.size());
+            if (i >= count) break;
+        } else {
+            idleLoop.valid = false;
+        }
+
+        if (unlikely(block->code == nullptr && !block->uncompilable)) {
+            block->code = recompiler->compile(block, PC);
+            block->codeAddress = PC;
+            block->uncompilable = block->code == nullptr;
+        }
+
+        // Compiled code assumes sequential entry (not in delay slot) at address it was compiled for
+        // and doesn't check instruction budget nor breakpoints
+        bool canRun = block->code != nullptr && PC == block->codeAddress && nextPC == PC + 4
+                      && (int)block->instructions.size() <= count - i && !(unlikely(breakpointsEnabled) && isHooked(PC));
+        if (likely(canRun)) {
+            i += block->code(this);
+            if (sys->state != System::State::run) return false;
+        } else if (!executeBlock(block, i, count)) {
+            return false;
+        }
+        if (unlikely(sys->scheduler->cpuShouldYield)) break;
     }
     return true;
 }
 
-void CPU::checkForInterrupts() {
-    if ((cop0.cause.interruptPending & cop0.status.interruptMask) && cop0.status.interruptEnable) {
-        instructions::exception(this, COP0::CAUSE::Exception::interrupt);
+// Loop which doesn't store anything and ends iteration in the same state as it started
+// can't leave until device event modifies memory or raises interrupt.
+// Events are never handled inside CPU slice - all iterations fitting in the rest of it are skipped.
+void CPU::skipIdleLoop(int& i, int count, int length) {
+    bool sameSlot = slots[0].reg == idleLoop.slot.reg && (slots[0].reg == DUMMY_REG || slots[0].data == idleLoop.slot.data);
+    bool sameState = idleLoop.valid && idleLoop.pc == PC && nextPC == PC + 4 && hi == idleLoop.hi && lo == idleLoop.lo && sameSlot
+                     && std::equal(reg, reg + REGISTER_COUNT, idleLoop.reg);
+
+    if (sameState && !sys->volatileRead && !interruptPending && !breakpointsEnabled) {
+        int iterations = (count - i) / length;
+        sys->cycles += (uint64_t)iterations * length;
+        i += iterations * length;
     }
+
+    idleLoop.valid = true;
+    idleLoop.pc = PC;
+    std::copy(reg, reg + REGISTER_COUNT, idleLoop.reg);
+    idleLoop.hi = hi;
+    idleLoop.lo = lo;
+    idleLoop.slot = slots[0];
+    sys->volatileRead = false;
+}
+
+void CPU::updateHookPages() {
+    hookPages.assign(HOOK_PAGE_COUNT, 0);
+    hookPages[0] = 1;  // BIOS function vectors A0, B0, C0
+    for (const auto& bp : breakpoints) {
+        hookPages[(bp.first & 0x1fff'ffff) / BlockCache::PAGE_SIZE] = 1;
+    }
+    updateBreakpointsFlag();
+}
+
+void CPU::updateBreakpointsFlag() {
+    breakpointsEnabled = !breakpoints.empty() || cop0.dcic.codeBreakpointEnabled();
+    unhookedPage = INVALID_PAGE;
+}
+
+void CPU::setMode(CpuMode mode) {
+    this->mode = mode;
+    blockCache.clear();
+
+    if (mode == CpuMode::jit && !recompiler) {
+        recompiler = std::make_unique<jit::Recompiler>(this);
+    }
+    if (recompiler) recompiler->reset();
+}
+
+void CPU::enterInterrupt() {
+    instructions::exception(this, COP0::CAUSE::Exception::interrupt);
+    fetchAndExecute();
+}
+
+void CPU::checkForInterrupts(Opcode next) {
+    if (!interruptPending) return;
+
+    // Hardware quirk:
+    // If COP2 opcode is executed when interrupt occures
+    // COP0 set EPC to the same opcode causing it to execute twice
+    // HACK: Delay interrupts if current opcode is GTE command
+    if (next.op == 18) return;
+
+    instructions::exception(this, COP0::CAUSE::Exception::interrupt);
 }
 
 void CPU::busError() { instructions::exception(this, COP0::CAUSE::Exception::busErrorData); }
@@ -1,8 +1,13 @@
 #pragma once
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
+#include <vector>
+#include "cpu/block_cache.h"
 #include "cpu/cop0.h"
+#include "cpu/cpu_mode.h"
 #include "cpu/gte/gte.h"
+#include "cpu/jit/recompiler.h"
 #include "opcode.h"
 #include "utils/macros.h"
 
@@ -89,9 +94,43 @@ struct CPU {
 
     bool breakpointsEnabled = false;
 
+    // Physical pages with BIOS function vectors or software breakpoints,
+    // instructions there are checked one by one (everywhere if hardware breakpoint is enabled)
+    inline static const uint32_t HOOK_PAGE_COUNT = 0x2000'0000 / BlockCache::PAGE_SIZE;
+    inline static const uint32_t INVALID_PAGE = 0xffff'ffff;
+    std::vector<uint8_t> hookPages;
+    uint32_t unhookedPage = INVALID_PAGE;  // Virtual page of last interpreted instruction, if it has no hooks
+    bool interruptPending = false;  // Interrupt requested and enabled in COP0, see updateInterruptPending
+
+    CpuMode mode;
+    int busToken;
+    BlockCache blockCache;
+    std::unique_ptr<jit::Recompiler> recompiler;
+
+    // CPU state at start of previous iteration of idle loop candidate
+    struct IdleLoop {
+        bool valid = false;
+        uint32_t pc;
+        uint32_t reg[REGISTER_COUNT];
+        uint32_t hi, lo;
+        LoadSlot slot;
+    } idleLoop;
+
     CPU(System* sys);
-    void checkForInterrupts();
-    INLINE void moveLoadDelaySlots();
+    ~CPU();
+    // Takes pending interrupt before executing next instruction
+    void checkForInterrupts(Opcode next);
+    // Takes pending interrupt unconditionally and executes first handler instruction
+    void enterInterrupt();
+    // Must be called after every change of I_STAT, I_MASK, COP0 SR or CAUSE
+    INLINE void updateInterruptPending() {
+        interruptPending = (cop0.cause.interruptPending & cop0.status.interruptMask) && cop0.status.interruptEnable;
+    }
+    INLINE void moveLoadDelaySlots() {
+        reg[slots[0].reg] = slots[0].data;
+        slots[0] = slots[1];
+        slots[1].reg = DUMMY_REG;  // invalidate
+    }
     INLINE void loadDelaySlot(uint32_t r, uint32_t data) {
         if (r == 0) return;
         if (r == slots[0].reg) {
@@ -122,7 +161,18 @@ struct CPU {
     void handleHardwareBreakpoints();
     bool handleSoftwareBreakpoints();
     INLINE uint32_t fetchInstruction(uint32_t address);
+    INLINE bool checkHooks();
+    INLINE void execute(Opcode opcode);
+    INLINE void fetchAndExecute();
     bool executeInstructions(int count);
+    bool interpret(int count);
+    bool executeBlocks(int count);
+    bool executeBlock(Block* block, int& i, int count);
+    bool executeThreaded(int count);
+    int runThreaded(Block* block);
+    bool executeJit(int count);
+    void skipIdleLoop(int& i, int count, int length);
+    void setMode(CpuMode mode);
 
     void busError();
 
@@ -139,13 +189,17 @@ struct CPU {
     // Helper
     void addBreakpoint(uint32_t address, Breakpoint bp = Breakpoint(true)) {
         breakpoints[address] = bp;
-        updateBreakpointsFlag();
+        updateHookPages();
     }
     void removeBreakpoint(uint32_t address) {
         breakpoints.erase(address);
-        updateBreakpointsFlag();
+        updateHookPages();
+    }
+    void updateHookPages();
+    void updateBreakpointsFlag();
+    INLINE bool isHooked(uint32_t address) {
+        return cop0.dcic.codeBreakpointEnabled() || hookPages[(address & 0x1fff'ffff) / BlockCache::PAGE_SIZE];
     }
-    void updateBreakpointsFlag() { breakpointsEnabled = !breakpoints.empty() || cop0.dcic.codeBreakpointEnabled(); }
 
     template <class Archive>
     void serialize(Archive& ar) {
@@ -155,6 +209,7 @@ struct CPU {
         ar(cop0);
         ar(gte);
         ar(icacheEnabled, icache);
+        updateInterruptPending();
     }
 };
 };  // namespace mips
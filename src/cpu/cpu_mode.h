@@ -0,0 +1,8 @@
+#pragma once
+
+enum class CpuMode {
+    interpreter,
+    cachedInterpreter,
+    threadedInterpreter,
+    jit,
+};
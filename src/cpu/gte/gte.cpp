@@ -1,12 +1,7 @@
 #include "gte.h"
 #include "config.h"
 
-GTE::GTE() : unrTable(generateUnrTable()) {
-    busToken = bus.listen<Event::Config::Gte>([&](auto) { reload(); });
-    reload();
-}
-
-GTE::~GTE() { bus.unlistenAll(busToken); }
+GTE::GTE() : unrTable(generateUnrTable()) {}
 
 constexpr std::array<uint8_t, 0x101> GTE::generateUnrTable() {
     std::array<uint8_t, 0x101> table = {{0}};
@@ -16,7 +11,7 @@ constexpr std::array<uint8_t, 0x101> GTE::generateUnrTable() {
     return table;
 }
 
-void GTE::reload() {
+void GTE::reload(const avocado_config_t& config) {
     widescreenHack = config.options.graphics.forceWidescreen;
     logging = config.debug.log.gte;
 }
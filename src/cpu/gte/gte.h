@@ -7,6 +7,8 @@
 #include "math.h"
 #include "utils/logic.h"
 
+struct avocado_config_t;
+
 namespace gui::debug {
 class GTE;
 }
@@ -66,9 +68,8 @@ class GTE {
     friend gui::debug::GTE;
 
     const std::array<uint8_t, 0x101> unrTable;
-    int busToken;
-    bool widescreenHack;
-    bool logging;
+    bool widescreenHack = false;
+    bool logging = false;
     bool sf;  // Used for setMac and setIr functions
     bool lm;  // saved as fields to prevent passing them to every function
 
@@ -99,7 +100,6 @@ class GTE {
     Flag flag;
 
     constexpr std::array<uint8_t, 0x101> generateUnrTable();
-    void reload();
 
     // Internal operations and helpers
     void multiplyVectors(gte::Vector<int16_t> v1, gte::Vector<int16_t> v2, gte::Vector<int16_t> tr = gte::Vector<int16_t>(0));
@@ -169,7 +169,7 @@ class GTE {
     std::vector<GTE_ENTRY> log;
 
     GTE();
-    ~GTE();
+    void reload(const avocado_config_t& config);
 
     uint32_t read(uint8_t n);
     void write(uint8_t n, uint32_t d);
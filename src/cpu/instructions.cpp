@@ -160,21 +160,11 @@ std::array<PrimaryInstruction, 64> SpecialTable = {{
 void exception(CPU *cpu, COP0::CAUSE::Exception cause) {
     using Exception = COP0::CAUSE::Exception;
 
-    // Hardware quirk:
-    // If COP2 opcode is executed when interrupt occures
-    // COP0 set EPC to the same opcode causing it to execute twice
-    // HACK: Delay interrupts if current opcode is GTE command
-    if (cause == Exception::interrupt) {
-        Opcode i(cpu->sys->readMemory32(cpu->exceptionPC));
-        if (i.op == 18) {  // COP2 opcode
-            return;
-        }
-    }
-
     cpu->cop0.cause.clearForException();
     cpu->cop0.cause.exception = cause;
 
     cpu->cop0.status.enterException();
+    cpu->updateInterruptPending();
 
     if (cause != Exception::busErrorInstruction) {
         cpu->cop0.cause.coprocessorNumber = cpu->_opcode.op & 3;
@@ -575,12 +565,14 @@ void op_cop0(CPU *cpu, Opcode i) {
             // MTC0 rt, cop0.rd
             cpu->cop0.write(i.rd, cpu->reg[i.rt]);
             cpu->updateBreakpointsFlag();
+            cpu->updateInterruptPending();
             break;
 
         case 16:
             // Restore from exception
             // RFE
             cpu->cop0.returnFromException();
+            cpu->updateInterruptPending();
             break;
 
         default: exception(cpu, COP0::CAUSE::Exception::reservedInstruction); break;
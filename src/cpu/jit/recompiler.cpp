@@ -0,0 +1,551 @@
+#include "recompiler.h"
+#include <fmt/core.h>
+#include <type_traits>
+#include <vector>
+#include "cpu/cpu.h"
+#include "system.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_X64
+#include "x64_emitter.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace mips::jit {
+#ifdef JIT_X64
+namespace {
+// Interpreter handlers are called directly, opcode is passed as 32bit integer
+static_assert(sizeof(Opcode) == 4 && std::is_trivially_copyable<Opcode>::value, "Opcode must be passed in register");
+
+const size_t MAX_INSTRUCTION_SIZE = 512;  // Worst case, including exit stubs
+const size_t MAX_BLOCK_OVERHEAD = 128;    // Prologue, epilogue and final exit
+
+#ifdef _WIN32
+const Reg ARG1 = RCX;
+const Reg ARG2 = RDX;
+const uint8_t SHADOW_SPACE = 32;
+#else
+const Reg ARG1 = RDI;
+const Reg ARG2 = RSI;
+const uint8_t SHADOW_SPACE = 0;
+#endif
+
+// sll, srl, sra, sllv, srlv, srav, mfhi, mthi, mflo, mtlo, addu, subu, and, or, xor, nor, slt, sltu
+const uint64_t NATIVE_SPECIAL = (1ull << 0) | (1ull << 2) | (1ull << 3) | (1ull << 4) | (1ull << 6) | (1ull << 7) | (1ull << 16)
+                                | (1ull << 17) | (1ull << 18) | (1ull << 19) | (1ull << 33) | (1ull << 35) | (1ull << 36) | (1ull << 37)
+                                | (1ull << 38) | (1ull << 39) | (1ull << 42) | (1ull << 43);
+
+bool isNativeAlu(Opcode i) {
+    if (i.op == 0) return (NATIVE_SPECIAL >> i.fun) & 1;
+    return i.op >= 9 && i.op <= 15;  // addiu, slti, sltiu, andi, ori, xori, lui
+}
+
+// j, jal, beq, bne, blez, bgtz - target known at compile time
+bool isNativeBranch(Opcode i) { return i.op >= 2 && i.op <= 7; }
+
+bool isBranch(Opcode i) {
+    if (i.op == 0) return i.fun == 8 || i.fun == 9;
+    return i.op >= 1 && i.op <= 7;
+}
+
+// Instructions which might put value in load delay slot
+bool isLoad(Opcode i) { return (i.op >= 0x20 && i.op <= 0x26) || i.op == 0x32 || i.op == 16 || i.op == 18; }
+bool isStore(Opcode i) { return (i.op >= 0x28 && i.op <= 0x2e) || i.op == 0x3a; }
+
+// lb, lh, lw, lbu, lhu, sb, sh, sw - done directly in fastmem arena
+bool isFastmemAccess(Opcode i) {
+    switch (i.op) {
+        case 0x20:
+        case 0x21:
+        case 0x23:
+        case 0x24:
+        case 0x25:
+        case 0x28:
+        case 0x29:
+        case 0x2b: return true;
+        default: return false;
+    }
+}
+
+int accessSize(Opcode i) {
+    switch (i.op & 3) {
+        case 0: return 1;
+        case 1: return 2;
+        default: return 4;
+    }
+}
+
+void enterInterrupt(CPU* cpu) { cpu->enterInterrupt(); }
+
+class BlockCompiler {
+    struct Exit {
+        Emitter::Label label;
+        int count;
+        int cycles;
+    };
+
+    // Fastmem access falling back to interpreter handler (unaligned, isolated cache or fault in arena)
+    struct SlowPath {
+        std::vector<Emitter::Label> entries;
+        const uint8_t* access;  // Host instruction accessing arena
+        const uint8_t* resume;  // Code after the instruction
+        const CachedInstruction* instruction;
+        uint32_t pc;
+        int count;   // Including this instruction
+        int cycles;  // Not flushed before this instruction
+        bool moveSlots;
+        bool delaySlot;
+    };
+
+    CPU* cpu;
+    Emitter& e;
+    uint8_t* arena;
+    std::vector<Exit> exits;
+    std::vector<SlowPath> slowPaths;
+
+    // State known at current point of emitted code
+    bool flagsDirty = true;  // inBranchDelay/branchTaken might be set
+    bool slotsDirty = true;  // slots[0] might contain pending load
+    bool pcDirty = false;    // PC/nextPC not written after native instructions
+    int cyclesFlushed = 0;
+
+    int32_t offset(const void* field) const { return (int32_t)((const uint8_t*)field - (const uint8_t*)cpu); }
+    int32_t reg(uint32_t r) const { return offset(&cpu->reg[r]); }
+
+    void addCycles(int cycles) {
+        if (cycles == 0) return;
+        e.movImm64(RAX, (uint64_t)&cpu->sys->cycles);
+        e.addQwordAtRaxImm(cycles);
+    }
+
+    void flushCycles(int count) {
+        addCycles(count - cyclesFlushed);
+        cyclesFlushed = count;
+    }
+
+    void exitIf(Emitter::Label label, int count) { exits.push_back({label, count, count - cyclesFlushed}); }
+    void exitIf(Emitter::Label label, int count, int cycles) { exits.push_back({label, count, cycles}); }
+
+    void epilogue(int count) {
+        e.movImm(RAX, count);
+        if (SHADOW_SPACE) e.addRsp(SHADOW_SPACE);
+        e.pop(RBX);
+        e.ret();
+    }
+
+    void saveStateForException(uint32_t pc) {
+        e.storeImm(offset(&cpu->exceptionPC), pc);
+        if (flagsDirty) {
+            e.loadByte(RAX, offset(&cpu->inBranchDelay));
+            e.storeByte(offset(&cpu->exceptionIsInBranchDelay), RAX);
+            e.loadByte(RAX, offset(&cpu->branchTaken));
+            e.storeByte(offset(&cpu->exceptionIsBranchTaken), RAX);
+            e.storeByteImm(offset(&cpu->inBranchDelay), 0);
+            e.storeByteImm(offset(&cpu->branchTaken), 0);
+        } else {
+            e.storeByteImm(offset(&cpu->exceptionIsInBranchDelay), 0);
+            e.storeByteImm(offset(&cpu->exceptionIsBranchTaken), 0);
+        }
+        flagsDirty = false;
+    }
+
+    // Only after memory access or on block entry, nothing else can change interrupt state
+    void checkForInterrupts(int count) {
+        e.testByteImm(offset(&cpu->interruptPending), 1);
+        auto noInterrupt = e.jcc(Cond::e);
+
+        // Takes the interrupt and executes first instruction of the handler (counting its cycle)
+        e.mov64(ARG1, RBX);
+        e.call((const void*)&jit::enterInterrupt);
+        exitIf(e.jmp(), count + 1, count - cyclesFlushed);
+
+        e.bind(noInterrupt);
+    }
+
+    void moveLoadDelaySlots() {
+        e.load(RCX, offset(&cpu->slots[0].reg));
+        e.load(RDX, offset(&cpu->slots[0].data));
+        e.storeIndexed(reg(0), RCX, RDX);
+        e.load64(RAX, offset(&cpu->slots[1]));
+        e.store64(offset(&cpu->slots[0]), RAX);
+        e.storeImm(offset(&cpu->slots[1].reg), DUMMY_REG);
+    }
+
+    // reg[r] = eax
+    void setReg(uint32_t r) {
+        if (r == 0) return;
+        e.store(reg(r), RAX);
+        if (slotsDirty) {
+            e.aluMemImm(Alu::cmp, offset(&cpu->slots[0].reg), r);
+            auto different = e.jcc(Cond::ne);
+            e.storeImm(offset(&cpu->slots[0].reg), DUMMY_REG);
+            e.bind(different);
+        }
+    }
+
+    void emitAlu(Opcode i) {
+        if (i.op == 0) {
+            if (i.fun == 17 || i.fun == 19) {  // mthi, mtlo
+                e.load(RAX, reg(i.rs));
+                e.store(offset(i.fun == 17 ? &cpu->hi : &cpu->lo), RAX);
+                return;
+            }
+            if (i.rd == 0) return;
+
+            switch (i.fun) {
+                case 0:
+                case 2:
+                case 3:
+                    e.load(RAX, reg(i.rt));
+                    if (i.sh) e.shiftImm(i.fun == 0 ? Shift::shl : i.fun == 2 ? Shift::shr : Shift::sar, RAX, i.sh);
+                    break;
+                case 4:
+                case 6:
+                case 7:
+                    e.load(RCX, reg(i.rs));
+                    e.load(RAX, reg(i.rt));
+                    e.shiftCl(i.fun == 4 ? Shift::shl : i.fun == 6 ? Shift::shr : Shift::sar, RAX);
+                    break;
+                case 16: e.load(RAX, offset(&cpu->hi)); break;
+                case 18: e.load(RAX, offset(&cpu->lo)); break;
+                case 33:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::add, RAX, reg(i.rt));
+                    break;
+                case 35:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::sub, RAX, reg(i.rt));
+                    break;
+                case 36:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::and_, RAX, reg(i.rt));
+                    break;
+                case 37:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::or_, RAX, reg(i.rt));
+                    break;
+                case 38:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::xor_, RAX, reg(i.rt));
+                    break;
+                case 39:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::or_, RAX, reg(i.rt));
+                    e.not_(RAX);
+                    break;
+                case 42:
+                case 43:
+                    e.load(RAX, reg(i.rs));
+                    e.alu(Alu::cmp, RAX, reg(i.rt));
+                    e.setcc(i.fun == 42 ? Cond::l : Cond::b, RAX);
+                    break;
+            }
+            setReg(i.rd);
+            return;
+        }
+
+        if (i.rt == 0) return;
+        switch (i.op) {
+            case 9:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::add, RAX, (int32_t)i.offset);
+                break;
+            case 10:
+            case 11:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::cmp, RAX, (int32_t)i.offset);
+                e.setcc(i.op == 10 ? Cond::l : Cond::b, RAX);
+                break;
+            case 12:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::and_, RAX, i.imm);
+                break;
+            case 13:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::or_, RAX, i.imm);
+                break;
+            case 14:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::xor_, RAX, i.imm);
+                break;
+            case 15: e.movImm(RAX, i.imm << 16); break;
+        }
+        setReg(i.rt);
+    }
+
+    // Fast path only, everything that System would need to handle jumps to slow path
+    void emitFastmemAccess(Opcode i, SlowPath& slow) {
+        int size = accessSize(i);
+        bool store = isStore(i);
+        if (store) {
+            e.testByteImm(offset(&cpu->cop0.status._reg) + 2, 1);  // isolateCache
+            slow.entries.push_back(e.jcc(Cond::ne));
+        }
+
+        e.load(RCX, reg(i.rs));
+        if (i.offset != 0) e.aluImm(Alu::add, RCX, (int32_t)i.offset);
+        if (size > 1) {
+            e.testImm(RCX, size - 1);  // Address error
+            slow.entries.push_back(e.jcc(Cond::ne));
+        }
+        if (store) e.load(RDX, reg(i.rt));
+        e.movImm64(RAX, (uint64_t)arena);
+
+        slow.access = e.position();
+        if (store) {
+            e.storeHost(RAX, RCX, RDX, size);
+            return;
+        }
+        e.loadHost(RDX, RAX, RCX, size, i.op == 0x20 || i.op == 0x21);
+
+        // loadDelaySlot(rt, edx)
+        if (i.rt == 0) return;
+        if (slotsDirty) {
+            e.aluMemImm(Alu::cmp, offset(&cpu->slots[0].reg), i.rt);
+            auto different = e.jcc(Cond::ne);
+            e.storeImm(offset(&cpu->slots[0].reg), DUMMY_REG);
+            e.bind(different);
+        }
+        e.storeImm(offset(&cpu->slots[1].reg), i.rt);
+        e.store(offset(&cpu->slots[1].data), RDX);
+    }
+
+    // Same as interpreted memory access, with cycles flushed only for the time of the call
+    void emitSlowPath(const SlowPath& slow) {
+        for (auto entry : slow.entries) e.bind(entry);
+        cpu->sys->fastmem->addSlowPath(slow.access, e.position());
+
+        Opcode i = slow.instruction->opcode;
+        addCycles(slow.cycles);
+        e.storeImm(offset(&cpu->_opcode), i.opcode);
+        e.mov64(ARG1, RBX);
+        e.movImm(ARG2, i.opcode);
+        e.call((const void*)slow.instruction->handler);
+        if (slow.moveSlots) moveLoadDelaySlots();
+
+        if (!slow.delaySlot) {
+            e.aluMemImm(Alu::cmp, offset(&cpu->PC), slow.pc + 4);
+            exitIf(e.jcc(Cond::ne), slow.count, 1);
+
+            if (isStore(i)) {
+                e.movImm64(RAX, (uint64_t)&cpu->blockCache.invalidated);
+                e.cmpByteAtRaxImm(0);
+                exitIf(e.jcc(Cond::ne), slow.count, 1);
+            }
+        }
+        addCycles(-slow.cycles);
+        e.bindTo(e.jmp(), slow.resume);
+    }
+
+    // PC and nextPC are already set, as in interpreter after setPC(nextPC)
+    void emitBranch(Opcode i, uint32_t pc) {
+        e.storeByteImm(offset(&cpu->inBranchDelay), 1);
+        if (i.op == 3) {  // jal
+            e.movImm(RAX, pc + 8);
+            setReg(31);
+        }
+
+        Emitter::Label notTaken = nullptr;
+        switch (i.op) {
+            case 4:
+            case 5:
+                e.load(RAX, reg(i.rs));
+                e.alu(Alu::cmp, RAX, reg(i.rt));
+                notTaken = e.jcc(i.op == 4 ? Cond::ne : Cond::e);
+                break;
+            case 6:
+            case 7:
+                e.load(RAX, reg(i.rs));
+                e.aluImm(Alu::cmp, RAX, 0);
+                notTaken = e.jcc(i.op == 6 ? Cond::g : Cond::le);
+                break;
+        }
+
+        uint32_t target;
+        if (i.op == 2 || i.op == 3) {
+            target = ((pc + 8) & 0xf0000000) | (i.target * 4);
+        } else {
+            target = pc + 4 + i.offset * 4;
+        }
+        e.storeImm(offset(&cpu->nextPC), target);
+        e.storeByteImm(offset(&cpu->branchTaken), 1);
+        if (notTaken) e.bind(notTaken);
+    }
+
+   public:
+    BlockCompiler(CPU* cpu, Emitter& e) : cpu(cpu), e(e), arena(cpu->sys->fastmem->getArena()) {}
+
+    void compile(const Block* block, uint32_t address) {
+        e.push(RBX);
+        if (SHADOW_SPACE) e.subRsp(SHADOW_SPACE);
+        e.mov64(RBX, ARG1);
+
+        bool delaySlot = false;
+        bool afterMemoryAccess = false;
+        int count = 0;
+        uint32_t pc = address;
+        uint32_t lastPc = address;
+        Opcode last;
+        SlowPath slow;
+
+        for (const auto& instruction : block->instructions) {
+            Opcode i = instruction.opcode;
+            bool native = isNativeAlu(i) || (!delaySlot && isNativeBranch(i));
+            bool fast = arena != nullptr && isFastmemAccess(i);
+            // Interrupt is delayed when GTE command is next (see CPU::checkForInterrupts)
+            bool interruptCheck = (count == 0 || afterMemoryAccess) && i.op != 18;
+
+            if (!native || flagsDirty || interruptCheck) saveStateForException(pc);
+            if (interruptCheck) checkForInterrupts(count);
+
+            // setPC(nextPC)
+            if (delaySlot) {
+                e.load(RAX, offset(&cpu->nextPC));
+                e.store(offset(&cpu->PC), RAX);
+                e.aluImm(Alu::add, RAX, 4);
+                e.store(offset(&cpu->nextPC), RAX);
+                pcDirty = false;
+            } else if (!native || isNativeBranch(i)) {
+                e.storeImm(offset(&cpu->PC), pc + 4);
+                e.storeImm(offset(&cpu->nextPC), pc + 8);
+                pcDirty = false;
+            } else {
+                pcDirty = true;
+            }
+
+            if (isNativeAlu(i)) {
+                emitAlu(i);
+            } else if (native) {
+                emitBranch(i, pc);
+            } else if (fast) {
+                slow = SlowPath{};
+                slow.instruction = &instruction;
+                slow.pc = pc;
+                slow.cycles = count - cyclesFlushed;
+                slow.delaySlot = delaySlot;
+                emitFastmemAccess(i, slow);
+            } else {
+                flushCycles(count);
+                e.storeImm(offset(&cpu->_opcode), i.opcode);
+                e.mov64(ARG1, RBX);
+                e.movImm(ARG2, i.opcode);
+                e.call((const void*)instruction.handler);
+            }
+
+            bool load = !native && isLoad(i);
+            bool moveSlots = slotsDirty || load;
+            if (moveSlots) moveLoadDelaySlots();
+            slotsDirty = load;
+            flagsDirty = isBranch(i);
+
+            count++;
+            last = i;
+            lastPc = pc;
+
+            if (fast) {
+                // Exceptions and self-modifying code are possible only in slow path
+                slow.count = count;
+                slow.moveSlots = moveSlots;
+                slow.resume = e.position();
+                slowPaths.push_back(std::move(slow));
+            } else if (!native && !delaySlot) {
+                // Exception was thrown
+                e.aluMemImm(Alu::cmp, offset(&cpu->PC), pc + 4);
+                exitIf(e.jcc(Cond::ne), count);
+
+                // Self-modifying code
+                if (isStore(i)) {
+                    e.movImm64(RAX, (uint64_t)&cpu->blockCache.invalidated);
+                    e.cmpByteAtRaxImm(0);
+                    exitIf(e.jcc(Cond::ne), count);
+                }
+
+                // COP0 might enable interrupts or breakpoints, let dispatcher handle it
+                if (i.op == 16) break;
+            }
+
+            afterMemoryAccess = !native && (isLoad(i) || isStore(i));
+            delaySlot = isBranch(i);
+            pc += 4;
+        }
+
+        if (pcDirty) {
+            e.storeImm(offset(&cpu->PC), lastPc + 4);
+            e.storeImm(offset(&cpu->nextPC), lastPc + 8);
+        }
+        e.storeImm(offset(&cpu->_opcode), last.opcode);
+        flushCycles(count);
+        epilogue(count);
+
+        for (const auto& slowPath : slowPaths) {
+            emitSlowPath(slowPath);
+        }
+        for (const auto& exit : exits) {
+            e.bind(exit.label);
+            addCycles(exit.cycles);
+            epilogue(exit.count);
+        }
+    }
+};
+}  // namespace
+
+Recompiler::Recompiler(CPU* cpu) : cpu(cpu) {
+#ifdef _WIN32
+    buffer = (uint8_t*)VirtualAlloc(nullptr, BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    void* ptr = mmap(nullptr, BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    buffer = ptr == MAP_FAILED ? nullptr : (uint8_t*)ptr;
+#endif
+    if (buffer == nullptr) {
+        fmt::print("[JIT] Unable to allocate executable memory, using cached interpreter\n");
+    }
+}
+
+Recompiler::~Recompiler() {
+    if (buffer == nullptr) return;
+#ifdef _WIN32
+    VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+    munmap(buffer, BUFFER_SIZE);
+#endif
+}
+
+BlockFunction Recompiler::compile(const Block* block, uint32_t address) {
+    if (buffer == nullptr) return nullptr;
+
+    size_t required = block->instructions.size() * MAX_INSTRUCTION_SIZE + MAX_BLOCK_OVERHEAD;
+    if (used + required > BUFFER_SIZE) {
+        // Out of space - drop everything, blocks will be compiled again
+        cpu->blockCache.clear();
+        reset();
+    }
+
+    uint8_t* code = buffer + used;
+    Emitter e(code);
+    BlockCompiler(cpu, e).compile(block, address);
+    used += e.size();
+    return (BlockFunction)code;
+}
+
+void Recompiler::reset() {
+    used = 0;
+    cpu->sys->fastmem->clearSlowPaths();
+}
+#else
+Recompiler::Recompiler(CPU* cpu) : cpu(cpu) { fmt::print("[JIT] Recompiler is not supported on this platform, using cached interpreter\n"); }
+
+Recompiler::~Recompiler() {}
+
+BlockFunction Recompiler::compile(const Block* block, uint32_t address) {
+    UNUSED(block);
+    UNUSED(address);
+    return nullptr;
+}
+
+void Recompiler::reset() {}
+#endif
+}  // namespace mips::jit
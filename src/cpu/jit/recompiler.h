@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace mips {
+struct CPU;
+struct Block;
+
+namespace jit {
+// Returns number of executed instructions
+using BlockFunction = int (*)(CPU* cpu);
+
+/*
+x86-64 recompiler - translates blocks from BlockCache to native code.
+Simple ALU instructions and static branches are emitted directly,
+everything else (memory access, COP0, GTE, mult/div, exceptions) calls
+interpreter handlers. Compiled code behaves exactly like the interpreter,
+including load delay slots, branch delay slots and instruction counting.
+*/
+class Recompiler {
+    static const size_t BUFFER_SIZE = 32 * 1024 * 1024;
+
+    CPU* cpu;
+    uint8_t* buffer = nullptr;
+    size_t used = 0;
+
+   public:
+    Recompiler(CPU* cpu);
+    ~Recompiler();
+
+    // Host is x86-64 and executable memory was allocated
+    bool isSupported() const { return buffer != nullptr; }
+
+    // Compiles block for given virtual address, returns nullptr if it's not possible
+    BlockFunction compile(const Block* block, uint32_t address);
+    void reset();
+};
+}  // namespace jit
+}  // namespace mips
@@ -0,0 +1,247 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace mips::jit {
+/*
+Minimal x86-64 machine code emitter - only what recompiler needs.
+All memory operands are addressed relative to RBX (pointer to CPU),
+or through absolute address loaded to RAX.
+*/
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R8 = 8, R9 = 9 };
+
+enum class Alu : uint8_t { add = 0, or_ = 1, and_ = 4, sub = 5, xor_ = 6, cmp = 7 };
+enum class Shift : uint8_t { shl = 4, shr = 5, sar = 7 };
+enum class Cond : uint8_t { b = 0x2, ae = 0x3, e = 0x4, ne = 0x5, l = 0xc, ge = 0xd, le = 0xe, g = 0xf };
+
+class Emitter {
+    uint8_t* start;
+    uint8_t* ptr;
+
+    void modrmRbx(uint8_t reg, int32_t disp) {
+        u8(0x80 | (reg << 3) | RBX);
+        u32(disp);
+    }
+
+   public:
+    using Label = uint8_t*;  // Points to rel32 field to be patched
+
+    Emitter(uint8_t* buffer) : start(buffer), ptr(buffer) {}
+
+    size_t size() const { return ptr - start; }
+    const uint8_t* position() const { return ptr; }
+
+    void u8(uint8_t v) { *ptr++ = v; }
+    void u32(uint32_t v) {
+        memcpy(ptr, &v, 4);
+        ptr += 4;
+    }
+    void u64(uint64_t v) {
+        memcpy(ptr, &v, 8);
+        ptr += 8;
+    }
+
+    // mov r32, [rbx+disp]
+    void load(Reg r, int32_t disp) {
+        u8(0x8b);
+        modrmRbx(r, disp);
+    }
+    // mov [rbx+disp], r32
+    void store(int32_t disp, Reg r) {
+        u8(0x89);
+        modrmRbx(r, disp);
+    }
+    // mov dword [rbx+disp], imm32
+    void storeImm(int32_t disp, uint32_t imm) {
+        u8(0xc7);
+        modrmRbx(0, disp);
+        u32(imm);
+    }
+    // mov r64, [rbx+disp]
+    void load64(Reg r, int32_t disp) {
+        u8(0x48);
+        load(r, disp);
+    }
+    // mov [rbx+disp], r64
+    void store64(int32_t disp, Reg r) {
+        u8(0x48);
+        store(disp, r);
+    }
+    // movzx r32, byte [rbx+disp]
+    void loadByte(Reg r, int32_t disp) {
+        u8(0x0f);
+        u8(0xb6);
+        modrmRbx(r, disp);
+    }
+    // mov byte [rbx+disp], r8 (al, cl, dl, bl only)
+    void storeByte(int32_t disp, Reg r) {
+        u8(0x88);
+        modrmRbx(r, disp);
+    }
+    // mov byte [rbx+disp], imm8
+    void storeByteImm(int32_t disp, uint8_t imm) {
+        u8(0xc6);
+        modrmRbx(0, disp);
+        u8(imm);
+    }
+    // mov [rbx+index*4+disp], r32
+    void storeIndexed(int32_t disp, Reg index, Reg r) {
+        u8(0x89);
+        u8(0x80 | (r << 3) | 4);
+        u8(0x80 | (index << 3) | RBX);
+        u32(disp);
+    }
+
+    // mov/movzx/movsx r32, [base+index] (size 1, 2 or 4)
+    void loadHost(Reg r, Reg base, Reg index, int size, bool signExtend) {
+        if (size == 4) {
+            u8(0x8b);
+        } else {
+            u8(0x0f);
+            u8((signExtend ? 0xbe : 0xb6) | (size == 2 ? 1 : 0));
+        }
+        u8((r << 3) | 4);
+        u8((index << 3) | base);
+    }
+    // mov [base+index], r8/r16/r32 (size 1, 2 or 4, r8 - al, cl, dl, bl only)
+    void storeHost(Reg base, Reg index, Reg r, int size) {
+        if (size == 2) u8(0x66);
+        u8(size == 1 ? 0x88 : 0x89);
+        u8((r << 3) | 4);
+        u8((index << 3) | base);
+    }
+
+    // mov r32, imm32
+    void movImm(Reg r, uint32_t imm) {
+        u8(0xb8 + r);
+        u32(imm);
+    }
+    // mov r64, imm64
+    void movImm64(Reg r, uint64_t imm) {
+        u8(r >= R8 ? 0x49 : 0x48);
+        u8(0xb8 + (r & 7));
+        u64(imm);
+    }
+    // mov dst64, src64
+    void mov64(Reg dst, Reg src) {
+        u8(0x48);
+        u8(0x89);
+        u8(0xc0 | (src << 3) | dst);
+    }
+
+    // op r32, [rbx+disp]
+    void alu(Alu op, Reg r, int32_t disp) {
+        u8(((uint8_t)op << 3) | 0x03);
+        modrmRbx(r, disp);
+    }
+    // op r32, imm32
+    void aluImm(Alu op, Reg r, uint32_t imm) {
+        u8(0x81);
+        u8(0xc0 | ((uint8_t)op << 3) | r);
+        u32(imm);
+    }
+    // op dword [rbx+disp], imm32
+    void aluMemImm(Alu op, int32_t disp, uint32_t imm) {
+        u8(0x81);
+        modrmRbx((uint8_t)op, disp);
+        u32(imm);
+    }
+    // cmp byte [rax], imm8
+    void cmpByteAtRaxImm(uint8_t imm) {
+        u8(0x80);
+        u8(0x38);
+        u8(imm);
+    }
+    // add qword [rax], imm32
+    void addQwordAtRaxImm(uint32_t imm) {
+        u8(0x48);
+        u8(0x81);
+        u8(0x00);
+        u32(imm);
+    }
+    // test byte [rbx+disp], imm8
+    void testByteImm(int32_t disp, uint8_t imm) {
+        u8(0xf6);
+        modrmRbx(0, disp);
+        u8(imm);
+    }
+    // test r32, imm32
+    void testImm(Reg r, uint32_t imm) {
+        u8(0xf7);
+        u8(0xc0 | r);
+        u32(imm);
+    }
+    // not r32
+    void not_(Reg r) {
+        u8(0xf7);
+        u8(0xc0 | (2 << 3) | r);
+    }
+    // shl/shr/sar r32, imm8
+    void shiftImm(Shift op, Reg r, uint8_t imm) {
+        u8(0xc1);
+        u8(0xc0 | ((uint8_t)op << 3) | r);
+        u8(imm);
+    }
+    // shl/shr/sar r32, cl
+    void shiftCl(Shift op, Reg r) {
+        u8(0xd3);
+        u8(0xc0 | ((uint8_t)op << 3) | r);
+    }
+    // setcc r8; movzx r32, r8
+    void setcc(Cond cond, Reg r) {
+        u8(0x0f);
+        u8(0x90 | (uint8_t)cond);
+        u8(0xc0 | r);
+        u8(0x0f);
+        u8(0xb6);
+        u8(0xc0 | (r << 3) | r);
+    }
+
+    void push(Reg r) { u8(0x50 + r); }
+    void pop(Reg r) { u8(0x58 + r); }
+    void ret() { u8(0xc3); }
+    // sub/add rsp, imm8
+    void subRsp(uint8_t imm) {
+        u8(0x48);
+        u8(0x83);
+        u8(0xec);
+        u8(imm);
+    }
+    void addRsp(uint8_t imm) {
+        u8(0x48);
+        u8(0x83);
+        u8(0xc4);
+        u8(imm);
+    }
+
+    // call absolute address (clobbers rax)
+    void call(const void* function) {
+        movImm64(RAX, (uint64_t)function);
+        u8(0xff);
+        u8(0xd0);
+    }
+
+    // jcc rel32, returns label to be bound later
+    Label jcc(Cond cond) {
+        u8(0x0f);
+        u8(0x80 | (uint8_t)cond);
+        Label label = ptr;
+        u32(0);
+        return label;
+    }
+    // jmp rel32, returns label to be bound later
+    Label jmp() {
+        u8(0xe9);
+        Label label = ptr;
+        u32(0);
+        return label;
+    }
+    // Point label to current position
+    void bind(Label label) { bindTo(label, ptr); }
+    void bindTo(Label label, const uint8_t* target) {
+        int32_t rel = (int32_t)(target - (label + 4));
+        memcpy(label, &rel, 4);
+    }
+};
+}  // namespace mips::jit
@@ -0,0 +1,347 @@
+#include "cpu.h"
+#include "system.h"
+
+/*
+Threaded interpreter - blocks from BlockCache are predecoded to records with resolved
+operands and address of handler, handlers jump directly to next one (computed goto).
+Simple ALU instructions and static branches have specialized handlers, which skip
+exception state, interrupt and load delay bookkeeping when it is known not to be needed.
+Everything else calls interpreter handlers, exactly as cached interpreter does.
+Requires labels as values (GCC, Clang), other compilers use cached interpreter instead.
+*/
+namespace mips {
+#if defined(__GNUC__)
+namespace {
+// clang-format off
+#define THREADED_OPS(X) \
+    X(nop) X(li) X(move) \
+    X(addu) X(subu) X(and_) X(or_) X(xor_) X(nor) X(slt) X(sltu) \
+    X(addiu) X(slti) X(sltiu) X(andi) X(ori) X(xori) \
+    X(sll) X(srl) X(sra) X(sllv) X(srlv) X(srav) \
+    X(beq) X(bne) X(blez) X(bgtz) X(j) X(jal)
+// clang-format on
+
+enum class Op {
+#define X(name) name,
+    THREADED_OPS(X)
+#undef X
+        generic,
+};
+
+// Instructions which might put value in load delay slot
+bool isLoad(Opcode i) { return (i.op >= 0x20 && i.op <= 0x26) || i.op == 0x32 || i.op == 16 || i.op == 18; }
+
+bool isBranch(Opcode i) {
+    if (i.op == 0) return i.fun == 8 || i.fun == 9;
+    return i.op >= 1 && i.op <= 7;
+}
+
+// Destination is always stored in rd, immediate in imm
+Op classify(Opcode i, uint32_t pc, ThreadedInstruction& t) {
+    t.rs = i.rs;
+    t.rt = i.rt;
+    t.rd = i.rd;
+
+    auto move = [&](uint8_t source) {
+        t.rs = source;
+        return Op::move;
+    };
+
+    if (i.op == 0) {
+        switch (i.fun) {
+            case 0: t.imm = i.sh; return i.rd == 0 ? Op::nop : Op::sll;
+            case 2: t.imm = i.sh; return i.rd == 0 ? Op::nop : Op::srl;
+            case 3: t.imm = i.sh; return i.rd == 0 ? Op::nop : Op::sra;
+            case 4: return i.rd == 0 ? Op::nop : Op::sllv;
+            case 6: return i.rd == 0 ? Op::nop : Op::srlv;
+            case 7: return i.rd == 0 ? Op::nop : Op::srav;
+            case 33:
+                if (i.rd == 0) return Op::nop;
+                if (i.rt == 0) return move(i.rs);
+                if (i.rs == 0) return move(i.rt);
+                return Op::addu;
+            case 35:
+                if (i.rd == 0) return Op::nop;
+                if (i.rt == 0) return move(i.rs);
+                return Op::subu;
+            case 36: return i.rd == 0 ? Op::nop : Op::and_;
+            case 37:
+                if (i.rd == 0) return Op::nop;
+                if (i.rt == 0) return move(i.rs);
+                if (i.rs == 0) return move(i.rt);
+                return Op::or_;
+            case 38:
+                if (i.rd == 0) return Op::nop;
+                if (i.rt == 0) return move(i.rs);
+                if (i.rs == 0) return move(i.rt);
+                return Op::xor_;
+            case 39: return i.rd == 0 ? Op::nop : Op::nor;
+            case 42: return i.rd == 0 ? Op::nop : Op::slt;
+            case 43: return i.rd == 0 ? Op::nop : Op::sltu;
+            default: return Op::generic;
+        }
+    }
+
+    // Branch target is relative to delay slot
+    switch (i.op) {
+        case 2: t.imm = ((pc + 8) & 0xf000'0000) | (i.target * 4); return Op::j;
+        case 3: t.imm = ((pc + 8) & 0xf000'0000) | (i.target * 4); return Op::jal;
+        case 4: t.imm = pc + 4 + i.offset * 4; return Op::beq;
+        case 5: t.imm = pc + 4 + i.offset * 4; return Op::bne;
+        case 6: t.imm = pc + 4 + i.offset * 4; return Op::blez;
+        case 7: t.imm = pc + 4 + i.offset * 4; return Op::bgtz;
+        default: break;
+    }
+
+    if (i.op < 9 || i.op > 15) return Op::generic;
+    if (i.rt == 0) return Op::nop;
+    t.rd = i.rt;
+
+    switch (i.op) {
+        case 9:
+            t.imm = (uint32_t)(int32_t)i.offset;
+            if (i.rs == 0) return Op::li;
+            if (t.imm == 0) return move(i.rs);
+            return Op::addiu;
+        case 10: t.imm = (uint32_t)(int32_t)i.offset; return Op::slti;
+        case 11: t.imm = (uint32_t)(int32_t)i.offset; return Op::sltiu;
+        case 12:
+            t.imm = i.imm;
+            if (i.rs == 0 || t.imm == 0) {
+                t.imm = 0;
+                return Op::li;
+            }
+            return Op::andi;
+        case 13:
+        case 14:
+            t.imm = i.imm;
+            if (i.rs == 0) return Op::li;
+            if (t.imm == 0) return move(i.rs);
+            return i.op == 13 ? Op::ori : Op::xori;
+        default: t.imm = i.imm << 16; return Op::li;  // lui
+    }
+}
+
+// dirtyLabels - variants used when previous instruction might have left value in load delay slot
+void translate(Block* block, uint32_t address, const void* const* labels, const void* const* dirtyLabels, const void* end) {
+    block->threaded.clear();
+    block->threaded.reserve(block->instructions.size() + 1);
+
+    uint32_t pc = address;
+    Opcode previous;
+    for (size_t n = 0; n < block->instructions.size(); n++, pc += 4) {
+        const auto& instruction = block->instructions[n];
+        ThreadedInstruction t = {};
+        t.handler = instruction.handler;
+        t.opcode = instruction.opcode;
+
+        // First instruction and branch delay slot need exception state and interrupt check - generic handler does that
+        Op op = classify(instruction.opcode, pc, t);
+        if (n == 0 || isBranch(previous)) op = Op::generic;
+
+        bool dirty = n != 0 && isLoad(previous);
+        t.label = (dirty ? dirtyLabels : labels)[(size_t)op];
+        block->threaded.push_back(t);
+        previous = instruction.opcode;
+    }
+
+    ThreadedInstruction sentinel = {};
+    sentinel.label = end;
+    block->threaded.push_back(sentinel);
+}
+}  // namespace
+
+// Returns number of executed instructions.
+// Block must be entered sequentially at codeAddress, with budget for all its instructions.
+int CPU::runThreaded(Block* block) {
+    static const void* const labels[] = {
+#define X(name) &&name,
+        THREADED_OPS(X)
+#undef X
+            &&generic,
+    };
+    static const void* const dirtyLabels[] = {
+#define X(name) &&name##_dirty,
+        THREADED_OPS(X)
+#undef X
+            &&generic,
+    };
+
+    if (block->threaded.empty()) translate(block, block->codeAddress, labels, dirtyLabels, &&end);
+
+    const ThreadedInstruction* first = block->threaded.data();
+    const ThreadedInstruction* ip = first;
+    const ThreadedInstruction* counted = first;  // Cycles of specialized handlers are added in bulk
+
+#define NEXT() \
+    ip++;      \
+    goto* ip->label
+
+// Pending load is moved to register after instruction reads its operands
+#define ALU(name, value)               \
+    name : {                           \
+        setPC(nextPC);                 \
+        reg[ip->rd] = (value);         \
+        NEXT();                        \
+    }                                  \
+    name##_dirty : {                   \
+        setPC(nextPC);                 \
+        uint32_t result = (value);     \
+        setReg(ip->rd, result);        \
+        moveLoadDelaySlots();          \
+        NEXT();                        \
+    }
+
+#define BRANCH(name, condition)            \
+    name : {                               \
+        setPC(nextPC);                     \
+        inBranchDelay = true;              \
+        if (condition) jump(ip->imm);      \
+        NEXT();                            \
+    }                                      \
+    name##_dirty : {                       \
+        setPC(nextPC);                     \
+        inBranchDelay = true;              \
+        if (condition) jump(ip->imm);      \
+        moveLoadDelaySlots();              \
+        NEXT();                            \
+    }
+
+    goto* ip->label;
+
+nop : {
+    setPC(nextPC);
+    NEXT();
+}
+nop_dirty : {
+    setPC(nextPC);
+    moveLoadDelaySlots();
+    NEXT();
+}
+
+    ALU(li, ip->imm);
+    ALU(move, reg[ip->rs]);
+    ALU(addu, reg[ip->rs] + reg[ip->rt]);
+    ALU(subu, reg[ip->rs] - reg[ip->rt]);
+    ALU(and_, reg[ip->rs] & reg[ip->rt]);
+    ALU(or_, reg[ip->rs] | reg[ip->rt]);
+    ALU(xor_, reg[ip->rs] ^ reg[ip->rt]);
+    ALU(nor, ~(reg[ip->rs] | reg[ip->rt]));
+    ALU(slt, (int32_t)reg[ip->rs] < (int32_t)reg[ip->rt]);
+    ALU(sltu, reg[ip->rs] < reg[ip->rt]);
+    ALU(addiu, reg[ip->rs] + ip->imm);
+    ALU(slti, (int32_t)reg[ip->rs] < (int32_t)ip->imm);
+    ALU(sltiu, reg[ip->rs] < ip->imm);
+    ALU(andi, reg[ip->rs] & ip->imm);
+    ALU(ori, reg[ip->rs] | ip->imm);
+    ALU(xori, reg[ip->rs] ^ ip->imm);
+    ALU(sll, reg[ip->rt] << ip->imm);
+    ALU(srl, reg[ip->rt] >> ip->imm);
+    ALU(sra, (uint32_t)((int32_t)reg[ip->rt] >> ip->imm));
+    ALU(sllv, reg[ip->rt] << (reg[ip->rs] & 0x1f));
+    ALU(srlv, reg[ip->rt] >> (reg[ip->rs] & 0x1f));
+    ALU(srav, (uint32_t)((int32_t)reg[ip->rt] >> (reg[ip->rs] & 0x1f)));
+
+    BRANCH(beq, reg[ip->rs] == reg[ip->rt]);
+    BRANCH(bne, reg[ip->rs] != reg[ip->rt]);
+    BRANCH(blez, (int32_t)reg[ip->rs] <= 0);
+    BRANCH(bgtz, (int32_t)reg[ip->rs] > 0);
+    BRANCH(j, true);
+
+jal : {
+    setPC(nextPC);
+    inBranchDelay = true;
+    reg[31] = nextPC;
+    jump(ip->imm);
+    NEXT();
+}
+jal_dirty : {
+    setPC(nextPC);
+    inBranchDelay = true;
+    setReg(31, nextPC);
+    jump(ip->imm);
+    moveLoadDelaySlots();
+    NEXT();
+}
+
+generic : {
+    // Same steps as CPU::executeBlock
+    uint32_t pc = PC;
+    sys->cycles += ip - counted;
+    counted = ip + 1;
+
+    saveStateForException();
+    // Interrupt is delayed when GTE command is next (see CPU::checkForInterrupts)
+    if (unlikely(interruptPending) && ip->opcode.op != 18) {
+        if (ip != first) _opcode = ip[-1].opcode;
+        enterInterrupt();
+        return (int)(ip - first) + 1;
+    }
+
+    _opcode = ip->opcode;
+    setPC(nextPC);
+    ip->handler(this, ip->opcode);
+    moveLoadDelaySlots();
+    sys->cycles++;
+
+    // Exception, interrupt enabled by I/O or COP0 write, self-modifying code, debugger
+    if (unlikely(PC != pc + 4 || interruptPending || blockCache.invalidated || sys->state != System::State::run)) {
+        return (int)(ip - first) + 1;
+    }
+    NEXT();
+}
+
+end:
+    _opcode = ip[-1].opcode;
+    sys->cycles += ip - counted;
+    return (int)(ip - first);
+
+#undef BRANCH
+#undef ALU
+#undef NEXT
+}
+
+bool CPU::executeThreaded(int count) {
+    idleLoop.valid = false;
+    for (int i = 0; i < count;) {
+        Block* block = blockCache.get(PC);
+        if (unlikely(block == nullptr)) {
+            idleLoop.valid = false;
+            if (!interpret(1)) return false;
+            i++;
+            continue;
+        }
+
+        // Native BIOS routine returned to the caller - lookup block at new PC
+        if (block->biosHook && sys->handleBiosFunction()) continue;
+        if (unlikely(block->idleLoop)) {
+            skipIdleLoop(i, count, (int)block->instructions.size());
+            if (i >= count) break;
+        } else {
+            idleLoop.valid = false;
+        }
+
+        if (block->threaded.empty()) block->codeAddress = PC;
+
+        // Same entry conditions as compiled code
+        bool canRun = PC == block->codeAddress && nextPC == PC + 4 && (int)block->instructions.size() <= count - i
+                      && !(unlikely(breakpointsEnabled) && isHooked(PC));
+        if (likely(canRun)) {
+            i += runThreaded(block);
+            if (sys->state != System::State::run) return false;
+        } else if (!executeBlock(block, i, count)) {
+            return false;
+        }
+        if (unlikely(sys->scheduler->cpuShouldYield)) break;
+    }
+    return true;
+}
+#else
+int CPU::runThreaded(Block* block) {
+    UNUSED(block);
+    return 0;
+}
+
+bool CPU::executeThreaded(int count) { return executeBlocks(count); }
+#endif
+}  // namespace mips
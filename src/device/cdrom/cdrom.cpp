@@ -1,9 +1,8 @@
 #include "cdrom.h"
 #include <fmt/core.h>
+#include <algorithm>
 #include <cassert>
-#include "config.h"
 #include "disc/empty.h"
-#include "sound/adpcm.h"
 #include "system.h"
 #include "utils/bcd.h"
 #include "utils/cd.h"
@@ -12,7 +11,7 @@ namespace device {
 namespace cdrom {
 
 CDROM::CDROM(System* sys) : sys(sys) {
-    verbose = config.debug.log.cdrom;
+    verbose = sys->config.debug.log.cdrom;
     disc = std::make_unique<disc::Empty>();
 }
 
@@ -22,124 +21,145 @@ void CDROM::step() {
         if ((interruptEnable & 7) & (interruptQueue.peek() & 7)) {
             sys->interrupt->trigger(interrupt::CDROM);
         }
+
+        // IRQ is asserted until all queued interrupts are acknowledged
+        sys->scheduler->schedule(Scheduler::Event::cdrom, Scheduler::POLL_PERIOD);
     }
+}
 
-    // TODO: Calculate correct interval using delta cycles
+void CDROM::schedulePoll() {
+    if (!sys->scheduler->isScheduled(Scheduler::Event::cdrom)) {
+        sys->scheduler->schedule(Scheduler::Event::cdrom, Scheduler::POLL_PERIOD);
+    }
+}
+
+int CDROM::sectorReadCycles() const {
+    // TODO: Calculate correct interval
     int MAGIC_NUMBER = 1150;  // FIXME: yey, magic numbers
     if (!mode.speed) MAGIC_NUMBER *= 2;
+    return MAGIC_NUMBER * Scheduler::POLL_PERIOD;
+}
 
-    if ((stat.read || stat.play) && readcnt++ == MAGIC_NUMBER) {
-        readcnt = 0;
-        const std::array<uint8_t, 12> sync = {{0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00}};
+void CDROM::postInterrupt(int irq) {
+    assert(irq <= 7);
 
-        auto pos = disc::Position::fromLba(readSector);
-        std::tie(rawSector, trackType) = disc->read(pos);
-        auto q = disc->getSubQ(pos);
-        if (q.validCrc()) {
-            this->lastQ = q;
-        }
-        readSector++;
+    interruptQueue.add(irq);
+    schedulePoll();
+}
 
-        if (trackType == disc::TrackType::AUDIO && stat.play) {
-            if (!mode.cddaEnable) {
-                return;
-            }
+void CDROM::stepRead() {
+    if (!stat.read && !stat.play) return;
+    sys->scheduler->reschedule(Scheduler::Event::cdromSector, sectorReadCycles());
 
-            if (memcmp(rawSector.data(), sync.data(), sync.size()) == 0) {
-                fmt::print("[CDROM] Trying to read Data track as audio\n");
-                return;
-            }
+    const std::array<uint8_t, 12> sync = {{0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00}};
 
-            if (mode.cddaReport) {
-                // Report--> INT1(stat, track, index, mm / amm, ss + 80h / ass, sect / asect, peaklo, peakhi)
-                auto pos = disc::Position::fromLba(readSector);
+    auto pos = disc::Position::fromLba(readSector);
+    std::tie(rawSector, trackType) = disc->read(pos);
+    auto q = disc->getSubQ(pos);
+    if (q.validCrc()) {
+        this->lastQ = q;
+    }
+    readSector++;
 
-                int track = disc->getTrackByPosition(pos);
+    if (trackType == disc::TrackType::AUDIO && stat.play) {
+        if (!mode.cddaEnable) {
+            return;
+        }
 
-                postInterrupt(1);
-                writeResponse(stat._reg);           // stat
-                writeResponse(bcd::toBcd(track));   // track
-                writeResponse(0x01);                // index
-                writeResponse(bcd::toBcd(pos.mm));  // minute (disc)
-                writeResponse(bcd::toBcd(pos.ss));  // second (disc)
-                writeResponse(bcd::toBcd(pos.ff));  // sector (disc)
-                writeResponse(bcd::toBcd(0));       // peaklo
-                writeResponse(bcd::toBcd(0));       // peakhi
+        if (memcmp(rawSector.data(), sync.data(), sync.size()) == 0) {
+            fmt::print("[CDROM] Trying to read Data track as audio\n");
+            return;
+        }
 
-                if (verbose) {
-                    fmt::print("CDROM: CDDA report -> ({})\n", dumpFifo(CDROM_response));
-                }
-            }
+        if (mode.cddaReport) {
+            // Report--> INT1(stat, track, index, mm / amm, ss + 80h / ass, sect / asect, peaklo, peakhi)
+            auto pos = disc::Position::fromLba(readSector);
 
-            if (!mute) {
-                // Decode Red Book Audio (16bit Stereo 44100Hz)
-                for (size_t i = 0; i < rawSector.size(); i += 4) {
-                    int16_t left = rawSector[i + 0] | (rawSector[i + 1] << 8);
-                    int16_t right = rawSector[i + 2] | (rawSector[i + 3] << 8);
+            int track = disc->getTrackByPosition(pos);
 
-                    audio.push_back(mixSample(std::make_pair(left, right)));
-                }
+            postInterrupt(1);
+            writeResponse(stat._reg);           // stat
+            writeResponse(bcd::toBcd(track));   // track
+            writeResponse(0x01);                // index
+            writeResponse(bcd::toBcd(pos.mm));  // minute (disc)
+            writeResponse(bcd::toBcd(pos.ss));  // second (disc)
+            writeResponse(bcd::toBcd(pos.ff));  // sector (disc)
+            writeResponse(bcd::toBcd(0));       // peaklo
+            writeResponse(bcd::toBcd(0));       // peakhi
+
+            if (verbose) {
+                fmt::print("CDROM: CDDA report -> ({})\n", dumpFifo(CDROM_response));
             }
-        } else if (trackType == disc::TrackType::DATA && stat.read) {
-            ackMoreData();
+        }
 
-            if (memcmp(rawSector.data(), sync.data(), sync.size()) != 0) {
-                fmt::print("CDROM: Invalid sync\n");
-                return;
+        if (!mute) {
+            // Decode Red Book Audio (16bit Stereo 44100Hz)
+            for (size_t i = 0; i < rawSector.size(); i += 4) {
+                int16_t left = rawSector[i + 0] | (rawSector[i + 1] << 8);
+                int16_t right = rawSector[i + 2] | (rawSector[i + 3] << 8);
+
+                audio.push_back(mixSample(std::make_pair(left, right)));
             }
+        }
+    } else if (trackType == disc::TrackType::DATA && stat.read) {
+        ackMoreData();
 
-            // uint8_t minute = rawSector[12];
-            // uint8_t second = rawSector[13];
-            // uint8_t frame = rawSector[14];
-            uint8_t mode = rawSector[15];
+        if (memcmp(rawSector.data(), sync.data(), sync.size()) != 0) {
+            fmt::print("CDROM: Invalid sync\n");
+            return;
+        }
 
-            uint8_t file = rawSector[16];
-            uint8_t channel = rawSector[17];
-            auto submode = static_cast<cd::Submode>(rawSector[18]);
-            auto codinginfo = static_cast<cd::Codinginfo>(rawSector[19]);
+        // uint8_t minute = rawSector[12];
+        // uint8_t second = rawSector[13];
+        // uint8_t frame = rawSector[14];
+        uint8_t mode = rawSector[15];
+
+        uint8_t file = rawSector[16];
+        uint8_t channel = rawSector[17];
+        auto submode = static_cast<cd::Submode>(rawSector[18]);
+        auto codinginfo = static_cast<cd::Codinginfo>(rawSector[19]);
+
+        // XA uses Mode2 sectors
+        // Does PSX even support Mode1?
+        if (mode != 2) {
+            fmt::print("CDROM: Not mode2 ({} instead)\n", mode);
+            return;
+        }
 
-            // XA uses Mode2 sectors
-            // Does PSX even support Mode1?
-            if (mode != 2) {
-                fmt::print("CDROM: Not mode2 ({} instead)\n", mode);
+        // Only Form2 ?
+        // Does PSX support Form1?
+        // Streaming
+        if (submode.form2 && submode.realtime) {
+            // Filter XA file/channel
+            if (this->mode.xaFilter && (filter.file != file || filter.channel != channel)) {
                 return;
             }
 
-            // Only Form2 ?
-            // Does PSX support Form1?
-            // Streaming
-            if (submode.form2 && submode.realtime) {
-                // Filter XA file/channel
-                if (this->mode.xaFilter && (filter.file != file || filter.channel != channel)) {
-                    return;
-                }
-
-                // Only realtime audio
-                if (!submode.audio || !submode.realtime) {
-                    return;
-                }
+            // Only realtime audio
+            if (!submode.audio || !submode.realtime) {
+                return;
+            }
 
-                if (codinginfo.bits == 1) {
-                    fmt::print("[CDROM] Unsupported 8bit mode for XA\n");
-                    exit(1);
-                }
+            if (codinginfo.bits == 1) {
+                fmt::print("[CDROM] Unsupported 8bit mode for XA\n");
+                exit(1);
+            }
 
-                if (this->mode.xaEnabled && !this->mute) {
-                    auto frame = ADPCM::decodeXA(rawSector.data() + 24, codinginfo);
+            if (this->mode.xaEnabled && !this->mute) {
+                auto frame = ADPCM::decodeXA(rawSector.data() + 24, codinginfo, xaState);
 
-                    for (auto sample : frame) {
-                        audio.push_back(mixSample(sample));
-                    }
+                for (auto sample : frame) {
+                    audio.push_back(mixSample(sample));
                 }
+            }
 
-                if (submode.endOfFile) {
-                    fmt::print("CDROM: End of file\n");
-                    stat.read = false;
-                    return;
-                }
-            } else {
-                // Plain data
+            if (submode.endOfFile) {
+                fmt::print("CDROM: End of file\n");
+                stat.read = false;
+                return;
             }
+        } else {
+            // Plain data
         }
     }
 }
@@ -223,6 +243,28 @@ uint8_t CDROM::readByte() {
     return data;
 }
 
+void CDROM::readBlock(uint8_t* data, size_t size) {
+    if (dataBuffer.empty()) {
+        fmt::print("[CDROM] Buffer empty\n");
+        std::fill_n(data, size, 0);
+        return;
+    }
+
+    int dataStart = 12;
+    if (!mode.sectorSize) dataStart += 12;
+    int dataEnd = mode.sectorSize ? 0x924 : 0x800;
+
+    size_t available = std::min<size_t>(std::max(dataEnd - dataBufferPointer, 0), size);
+    std::copy_n(dataBuffer.begin() + dataStart + dataBufferPointer, available, data);
+    // Reading outside of data buffer returns the same value as readByte
+    std::fill_n(data + available, size - available, dataBuffer[dataStart + dataEnd - (mode.sectorSize ? 4 : 8)]);
+    dataBufferPointer += size;
+
+    if (available > 0 && isBufferEmpty()) {
+        status.dataFifoEmpty = 0;
+    }
+}
+
 std::string CDROM::dumpFifo(const FIFO& f) {
     std::string log = "";
     for (size_t i = 0u; i < f.size(); i++) {
@@ -286,9 +328,14 @@ void CDROM::handleCommand(uint8_t cmd) {
     status.parameterFifoFull = 1;
     status.transmissionBusy = 1;
     status.xaFifoEmpty = 0;
+
+    if ((stat.read || stat.play) && !sys->scheduler->isScheduled(Scheduler::Event::cdromSector)) {
+        sys->scheduler->schedule(Scheduler::Event::cdromSector, sectorReadCycles());
+    }
 }
 
 void CDROM::write(uint32_t address, uint8_t data) {
+    schedulePoll();
     if (address == 0) {
         if (verbose == 3) fmt::print("CDROM: W INDEX: 0x{:02x}\n", data);
         status.index = data & 3;
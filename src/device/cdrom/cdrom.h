@@ -4,6 +4,7 @@
 #include <memory>
 #include "disc/disc.h"
 #include "fifo.h"
+#include "sound/adpcm.h"
 
 struct System;
 
@@ -120,6 +121,7 @@ class CDROM {
     uint8_t volumeRightToRight = 0x80;  // zeroed on reset, but have 80 0 0 80 values
 
     System* sys;
+    ADPCM::XaState xaState;
     int readSector = 0;
     int seekSector = 0;
 
@@ -171,11 +173,9 @@ class CDROM {
         return param;
     }
 
-    void postInterrupt(int irq) {
-        assert(irq <= 7);
-
-        interruptQueue.add(irq);
-    }
+    void postInterrupt(int irq);
+    void schedulePoll();
+    int sectorReadCycles() const;
 
     std::string dumpFifo(const FIFO& f);
     std::pair<int16_t, int16_t> mixSample(std::pair<int16_t, int16_t> sample);
@@ -189,8 +189,9 @@ class CDROM {
 
     bool isBufferEmpty();
     uint8_t readByte();
+    // Same as readByte repeated size times
+    void readBlock(uint8_t* data, size_t size);
 
-    int readcnt = 0;
     disc::TrackType trackType;
     std::unique_ptr<disc::Disc> disc;
     disc::SubchannelQ lastQ;
@@ -198,6 +199,7 @@ class CDROM {
 
     CDROM(System* sys);
     void step();
+    void stepRead();  // Next sector while reading or playing
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
 
@@ -226,7 +228,6 @@ class CDROM {
         ar(rawSector);
         ar(dataBuffer);
         ar(dataBufferPointer);
-        ar(readcnt);
         ar(trackType);
         ar(lastQ);
         ar(mute);
@@ -1,5 +1,5 @@
 #include "controller.h"
-#include "config.h"
+#include "input/input_manager.h"
 #include "peripherals/analog_controller.h"
 #include "peripherals/digital_controller.h"
 #include "peripherals/mouse.h"
@@ -38,27 +38,32 @@ void Controller::handleByte(uint8_t byte) {
         }
         if (card[port]->state == 0) deviceSelected = DeviceSelected::None;
     }
+
+    if (irqTimer > 0 && !sys->scheduler->isScheduled(Scheduler::Event::controller)) {
+        sys->scheduler->schedule(Scheduler::Event::controller, Scheduler::POLL_PERIOD);
+    }
 }
 
 Controller::Controller(System* sys) : sys(sys) {
-    busToken = bus.listen<Event::Config::Controller>([&](auto) { reload(); });
+    busToken = sys->bus->listen<Event::Config::Controller>([&](auto) { reload(); });
 
     reload();
 
     for (auto i = 0; i < (int)card.size(); i++) {
-        card[i] = std::make_unique<peripherals::MemoryCard>(i + 1);
+        card[i] = std::make_unique<peripherals::MemoryCard>(i + 1, sys->config.debug.log.memoryCard);
     }
 }
 
-Controller::~Controller() { bus.unlistenAll(busToken); }
+Controller::~Controller() { sys->bus->unlistenAll(busToken); }
 void Controller::reload() {
-    auto createDevice = [](int num) -> std::unique_ptr<peripherals::AbstractDevice> {
+    auto createDevice = [this](int num) -> std::unique_ptr<peripherals::AbstractDevice> {
         num += 1;
-        ControllerType type = config.controller[num - 1].type;
+        ControllerType type = sys->config.controller[num - 1].type;
+        int verbose = sys->config.debug.log.controller;
         if (type == ControllerType::digital) {
-            return std::make_unique<peripherals::DigitalController>(num);
+            return std::make_unique<peripherals::DigitalController>(num, verbose);
         } else if (type == ControllerType::analog) {
-            return std::make_unique<peripherals::AnalogController>(num);
+            return std::make_unique<peripherals::AnalogController>(num, verbose, sys->bus.get());
         } else if (type == ControllerType::mouse) {
             return std::make_unique<peripherals::Mouse>(num);
         } else {
@@ -81,6 +86,11 @@ void Controller::step() {
     if (irq) {
         sys->interrupt->trigger(interrupt::CONTROLLER);
     }
+
+    // Polled only until IRQ is acknowledged
+    if (irqTimer > 0 || irq) {
+        sys->scheduler->schedule(Scheduler::Event::controller, Scheduler::POLL_PERIOD);
+    }
 }
 
 uint8_t Controller::read(uint32_t address) {
@@ -131,6 +141,8 @@ void Controller::write(uint32_t address, uint8_t data) {
 }
 
 void Controller::update() {
+    // Input changed by frontend becomes visible to peripherals once per frame
+    if (auto inputManager = InputManager::getInstance()) inputManager->applyUpdates();
     for (auto& ctrl : controller) ctrl->update();
 }
 }  // namespace controller
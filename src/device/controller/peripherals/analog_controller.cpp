@@ -1,11 +1,12 @@
 #include "analog_controller.h"
 #include <fmt/core.h>
 #include <magic_enum.hpp>
-#include "config.h"
+#include "utils/event.h"
 #include "input/input_manager.h"
 
 namespace peripherals {
-AnalogController::AnalogController(int port) : DigitalController(Type::Analog, port) {}
+AnalogController::AnalogController(int port, int verbose, Dexode::EventBus* bus)
+    : DigitalController(Type::Analog, port, verbose), bus(bus) {}
 
 uint8_t AnalogController::_handle(uint8_t byte) {
     if (state == 0) command = Command::None;
@@ -115,7 +116,7 @@ uint8_t AnalogController::handleReadAnalog(uint8_t byte) {
             state = 0;
             // Do not send vibration events on continuous 0 values
             if (vibration != prevVibration || vibration != 0) {
-                bus.notify(Event::Controller::Vibration{port, vibration.small, vibration.big});
+                bus->notify(Event::Controller::Vibration{port, vibration.small, vibration.big});
             }
             prevVibration = vibration;
             return left.y;
@@ -158,7 +159,6 @@ uint8_t AnalogController::handleExitConfiguration(uint8_t byte) {
 }
 
 uint8_t AnalogController::handleSetLed(uint8_t byte) {
-    static uint8_t param;
     switch (state) {
         case 2: state++; return 0x5a;
         case 3:
@@ -196,31 +196,30 @@ uint8_t AnalogController::handleLedStatus(uint8_t byte) {
 }
 
 uint8_t AnalogController::handleUnlockRumble(uint8_t byte) {
-    static uint8_t a, b, c, d, e, f;
     switch (state) {
         case 2: state++; return 0x5a;
         case 3:
-            a = byte;
+            unlockRumble[0] = byte;
             state++;
             return 0;
         case 4:
-            b = byte;
+            unlockRumble[1] = byte;
             state++;
             return 0;
         case 5:
-            c = byte;
+            unlockRumble[2] = byte;
             state++;
             return 0;
         case 6:
-            d = byte;
+            unlockRumble[3] = byte;
             state++;
             return 0;
         case 7:
-            e = byte;
+            unlockRumble[4] = byte;
             state++;
             return 0;
         case 8:
-            f = byte;
+            unlockRumble[5] = byte;
             state = 0;
             // Note: 40 Winks does not use Unlock rumble command
             // It enables analog mode using 0x4c command
@@ -232,7 +231,6 @@ uint8_t AnalogController::handleUnlockRumble(uint8_t byte) {
 }
 
 uint8_t AnalogController::handleUnknown46(uint8_t byte) {
-    static uint8_t param;
     switch (state) {
         case 2: state++; return 0x5a;
         case 3:
@@ -286,8 +284,6 @@ void AnalogController::update() {
     auto inputManager = InputManager::getInstance();
     if (inputManager == nullptr) return;
 
-    static bool analogPressed = false;
-
     if (inputManager->getDigital(path + "analog")) {
         if (!analogPressed) {
             analogPressed = true;
@@ -1,6 +1,10 @@
 #pragma once
 #include "digital_controller.h"
 
+namespace Dexode {
+class EventBus;
+}
+
 namespace peripherals {
 struct AnalogController : public DigitalController {
    protected:
@@ -56,9 +60,13 @@ struct AnalogController : public DigitalController {
     bool ledEnabled = false;
     bool configurationMode = false;
     Vibration prevVibration, vibration;
+    bool analogPressed = false;
+    uint8_t param = 0;             // First argument of SetLed and Unknown46 commands
+    uint8_t unlockRumble[6] = {};  // UnlockRumble arguments
+    Dexode::EventBus* bus;         // Vibration events
 
    public:
-    AnalogController(int Port);
+    AnalogController(int Port, int verbose, Dexode::EventBus* bus);
     uint8_t handle(uint8_t byte) override;
     void update() override;
 };
@@ -1,6 +1,5 @@
 #include "digital_controller.h"
 #include <fmt/core.h>
-#include "config.h"
 #include "input/input_manager.h"
 
 namespace peripherals {
@@ -27,10 +26,10 @@ void DigitalController::ButtonState::setByName(const std::string& name, bool val
 #undef BUTTON
 }
 
-DigitalController::DigitalController(Type type, int port)
-    : AbstractDevice(type, port), verbose(config.debug.log.controller), path(fmt::format("controller/{}/", port)) {}
+DigitalController::DigitalController(Type type, int port, int verbose)
+    : AbstractDevice(type, port), verbose(verbose), path(fmt::format("controller/{}/", port)) {}
 
-DigitalController::DigitalController(int port) : DigitalController(Type::Digital, port) {}
+DigitalController::DigitalController(int port, int verbose) : DigitalController(Type::Digital, port, verbose) {}
 
 uint8_t DigitalController::_handle(uint8_t byte) {
     switch (state) {
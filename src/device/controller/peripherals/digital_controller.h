@@ -38,12 +38,12 @@ class DigitalController : public AbstractDevice {
     ButtonState buttons;
     std::string path;
 
-    DigitalController(Type type, int port);
+    DigitalController(Type type, int port, int verbose);
     uint8_t _handle(uint8_t byte);
     uint8_t handleRead(uint8_t byte);
 
    public:
-    DigitalController(int Port);
+    DigitalController(int Port, int verbose);
     uint8_t handle(uint8_t byte) override;
     void update() override;
 };
@@ -1,10 +1,9 @@
 #include "memory_card.h"
 #include <fmt/core.h>
-#include "config.h"
 
 namespace peripherals {
 
-MemoryCard::MemoryCard(int port) : AbstractDevice(Type::MemoryCard, port) { verbose = config.debug.log.memoryCard; }
+MemoryCard::MemoryCard(int port, int verbose) : AbstractDevice(Type::MemoryCard, port), verbose(verbose) {}
 
 uint8_t MemoryCard::handle(uint8_t byte) {
     if (state == 0) command = Command::None;
@@ -36,7 +36,7 @@ struct MemoryCard : public AbstractDevice {
     bool inserted = true;
     bool dirty = false;
 
-    MemoryCard(int port);
+    MemoryCard(int port, int verbose);
     uint8_t handle(uint8_t byte) override;
 };
 }  // namespace peripherals
\ No newline at end of file
@@ -60,12 +60,42 @@ void DMA::write(uint32_t address, uint8_t data) {
     }
 
     dma[channel]->write(address % 0x10, data);
-    if (dma[channel]->irqFlag) {
-        dma[channel]->irqFlag = false;
-        if (status.getEnableDma(channel)) {
-            status.setFlagDma(channel, 1);
-            pendingInterrupt = status.calcMasterFlag();
-        }
+    checkIrq(channel);
+}
+
+uint32_t DMA::read32(uint32_t address) {
+    int channel = address / 0x10;
+    if (channel < 7) return dma[channel]->read32(address % 0x10);
+
+    if (address == 0x70) return control._reg;
+    if (address == 0x74) return status._reg;
+    return 0;
+}
+
+void DMA::write32(uint32_t address, uint32_t data) {
+    int channel = address / 0x10;
+    if (channel < 7) {
+        dma[channel]->write32(address % 0x10, data);
+        checkIrq(channel);
+        return;
+    }
+
+    if (address == 0x70) {
+        control._reg = data;
+    } else if (address == 0x74) {
+        status.write32(data);
+    } else {
+        fmt::print("W Unimplemented DMA address 0x{:08x}\n", address + 0x80);
+    }
+}
+
+void DMA::checkIrq(int channel) {
+    if (!dma[channel]->irqFlag) return;
+    dma[channel]->irqFlag = false;
+    if (status.getEnableDma(channel)) {
+        status.setFlagDma(channel, 1);
+        pendingInterrupt = status.calcMasterFlag();
+        if (pendingInterrupt) sys->scheduler->schedule(Scheduler::Event::dma, Scheduler::POLL_PERIOD);
     }
 }
 
@@ -76,6 +76,12 @@ union DICR {
         masterFlag = calcMasterFlag();
     }
 
+    void write32(uint32_t value) {
+        // Flags (upper byte) are acknowledged by writing 1
+        _reg = (_reg & 0xff000000 & ~value) | (value & 0x00ffffff);
+        masterFlag = calcMasterFlag();
+    }
+
     bool calcMasterFlag() {
         uint8_t enables = (_reg & 0x7F0000) >> 16;
         uint8_t flags = (_reg & 0x7F000000) >> 24;
@@ -102,11 +108,16 @@ class DMA {
 
     System* sys;
 
+    // Raises DMA IRQ if channel finished transfer
+    void checkIrq(int channel);
+
    public:
     DMA(System* sys);
     void step();
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
+    uint32_t read32(uint32_t address);
+    void write32(uint32_t address, uint32_t data);
 
     bool isChannelEnabled(Channel ch);
 
@@ -5,4 +5,8 @@ namespace device::dma {
 DMA0Channel::DMA0Channel(Channel channel, System* sys, mdec::MDEC* mdec) : DMAChannel(channel, sys), mdec(mdec) {}
 
 void DMA0Channel::writeDevice(uint32_t data) { mdec->write(0, data); }
+
+void DMA0Channel::writeDeviceBlock(const uint32_t* data, size_t words) {
+    for (size_t i = 0; i < words; i++) mdec->write(0, data[i]);
+}
 }  // namespace device::dma
\ No newline at end of file
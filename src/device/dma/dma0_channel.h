@@ -10,6 +10,7 @@ class DMA0Channel : public DMAChannel {
     mdec::MDEC* mdec;
 
     void writeDevice(uint32_t data) override;
+    void writeDeviceBlock(const uint32_t* data, size_t words) override;
 
    public:
     DMA0Channel(Channel channel, System* sys, mdec::MDEC* mdec);
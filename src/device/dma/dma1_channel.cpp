@@ -5,4 +5,8 @@ namespace device::dma {
 DMA1Channel::DMA1Channel(Channel channel, System* sys, mdec::MDEC* mdec) : DMAChannel(channel, sys), mdec(mdec) {}
 
 uint32_t DMA1Channel::readDevice() { return mdec->read(0); }
+
+void DMA1Channel::readDeviceBlock(uint32_t* data, size_t words) {
+    for (size_t i = 0; i < words; i++) data[i] = mdec->read(0);
+}
 }  // namespace device::dma
\ No newline at end of file
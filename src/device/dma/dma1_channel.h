@@ -10,6 +10,7 @@ class DMA1Channel : public DMAChannel {
     mdec::MDEC* mdec;
 
     uint32_t readDevice() override;
+    void readDeviceBlock(uint32_t* data, size_t words) override;
 
    public:
     DMA1Channel(Channel channel, System* sys, mdec::MDEC* mdec);
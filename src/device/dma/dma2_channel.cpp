@@ -1,10 +1,80 @@
 #include "dma2_channel.h"
+#include <fmt/core.h>
+#include <algorithm>
+#include <magic_enum.hpp>
 #include "device/gpu/gpu.h"
+#include "system.h"
 
 namespace device::dma {
-DMA2Channel::DMA2Channel(Channel channel, System *sys, gpu::GPU *gpu) : DMAChannel(channel, sys), gpu(gpu) {}
+DMA2Channel::DMA2Channel(Channel channel, System *sys, gpu::GPU *gpu)
+    : DMAChannel(channel, sys), gpu(gpu), visited(System::RAM_SIZE / 4) {}
 
 uint32_t DMA2Channel::readDevice() { return gpu->read(0); }
 
 void DMA2Channel::writeDevice(uint32_t data) { gpu->write(0, data); }
+
+void DMA2Channel::readDeviceBlock(uint32_t *data, size_t words) {
+    for (size_t i = 0; i < words; i++) data[i] = gpu->read(0);
+}
+
+void DMA2Channel::writeDeviceBlock(const uint32_t *data, size_t words) { gpu->submitPackets(data, words); }
+
+void DMA2Channel::startTransfer() {
+    if (control.syncMode != CHCR::SyncMode::linkedList) {
+        DMAChannel::startTransfer();
+        return;
+    }
+
+    control.startTrigger = CHCR::StartTrigger::clear;
+    transferLinkedList();
+
+    irqFlag = true;
+    control.enabled = CHCR::Enabled::completed;
+}
+
+// Ordering table is walked directly in RAM, packets of each node are passed to GPU at once
+void DMA2Channel::transferLinkedList() {
+    using namespace magic_enum;
+    const uint32_t ramWords = System::RAM_SIZE / 4;
+    auto *ram = reinterpret_cast<const uint32_t *>(sys->ram.data());
+    uint32_t addr = baseAddress.address;
+
+    if (verbose) {
+        fmt::print("[DMA{}] {:<8} {} RAM @ 0x{:08x}, {}\n", (int)channel, enum_name(channel), control.dir(), addr,
+                   enum_name(control.syncMode));
+    }
+
+    for (;;) {
+        uint32_t node = (addr & (System::RAM_SIZE - 4)) / 4;
+        uint32_t blockInfo = ram[node];
+        uint32_t commandCount = blockInfo >> 24;
+        uint32_t nextAddr = blockInfo & 0xffffff;
+
+        if (verbose >= 2) {
+            fmt::print("[DMA{}] {:<8} {} RAM @ 0x{:08x}, {}, count: {}, nextAddr: 0x{:08x}\n", (int)channel, enum_name(channel),
+                       control.dir(), addr, enum_name(control.syncMode), commandCount, nextAddr);
+        }
+
+        // Node payload might wrap around RAM end
+        uint32_t words = std::min(commandCount, ramWords - node - 1);
+        gpu->submitPackets(ram + node + 1, words);
+        if (words < commandCount) gpu->submitPackets(ram, commandCount - words);
+
+        addr = nextAddr;
+        if (addr == 0xffffff || addr == 0) break;
+
+        uint32_t next = (addr & (System::RAM_SIZE - 4)) / 4;
+        if (visited[next]) {
+            fmt::print("[DMA{}] GPU DMA transfer loop detected, breaking.\n", (int)channel);
+            break;
+        }
+        visited[next] = true;
+        visitedNodes.push_back(next);
+    }
+
+    for (auto node : visitedNodes) visited[node] = false;
+    visitedNodes.clear();
+
+    baseAddress.address = addr;
+}
 }  // namespace device::dma
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "dma_channel.h"
 
 namespace gpu {
@@ -9,8 +10,16 @@ namespace device::dma {
 class DMA2Channel : public DMAChannel {
     gpu::GPU *gpu;
 
+    // Ordering table nodes visited by current linked list transfer (one bit per RAM word)
+    std::vector<bool> visited;
+    std::vector<uint32_t> visitedNodes;
+
     uint32_t readDevice() override;
     void writeDevice(uint32_t data) override;
+    void readDeviceBlock(uint32_t *data, size_t words) override;
+    void writeDeviceBlock(const uint32_t *data, size_t words) override;
+    void startTransfer() override;
+    void transferLinkedList();
 
    public:
     DMA2Channel(Channel channel, System *sys, gpu::GPU *gpu);
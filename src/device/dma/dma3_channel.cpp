@@ -12,6 +12,8 @@ uint32_t DMA3Channel::readDevice() {
     return data;
 }
 
+void DMA3Channel::readDeviceBlock(uint32_t* data, size_t words) { cdrom->readBlock(reinterpret_cast<uint8_t*>(data), words * 4); }
+
 DMA3Channel::DMA3Channel(Channel channel, System* sys, device::cdrom::CDROM* cdrom) : DMAChannel(channel, sys), cdrom(cdrom) {}
 
 }  // namespace device::dma
@@ -5,7 +5,6 @@ namespace device::dma {
 DMA4Channel::DMA4Channel(Channel channel, System *sys, spu::SPU *spu) : DMAChannel(channel, sys), spu(spu) {}
 
 uint32_t DMA4Channel::readDevice() {
-    // TODO: Do direct RAM write/read using memoryRead
     uint32_t data = 0;
     data |= spu->read(0x1a8);
     data |= spu->read(0x1a8) << 8;
@@ -19,4 +18,10 @@ void DMA4Channel::writeDevice(uint32_t data) {
     spu->write(0x1a8, data >> 16);
     spu->write(0x1a8, data >> 24);
 }
+
+void DMA4Channel::readDeviceBlock(uint32_t *data, size_t words) { spu->dmaRead(reinterpret_cast<uint8_t *>(data), words * 4); }
+
+void DMA4Channel::writeDeviceBlock(const uint32_t *data, size_t words) {
+    spu->dmaWrite(reinterpret_cast<const uint8_t *>(data), words * 4);
+}
 }  // namespace device::dma
\ No newline at end of file
@@ -11,6 +11,8 @@ class DMA4Channel : public DMAChannel {
 
     uint32_t readDevice() override;
     void writeDevice(uint32_t data) override;
+    void readDeviceBlock(uint32_t *data, size_t words) override;
+    void writeDeviceBlock(const uint32_t *data, size_t words) override;
 
    public:
     DMA4Channel(Channel channel, System *sys, spu::SPU *spu);
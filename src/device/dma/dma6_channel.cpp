@@ -30,10 +30,14 @@ void DMA6Channel::startTransfer() {
                    wordCount);
     }
 
+    // Ordering table is written directly to RAM, code on touched pages is dropped afterwards
+    auto* ram = reinterpret_cast<uint32_t*>(sys->ram.data());
     for (int i = wordCount - 1; i >= 0; i--, addr -= 4) {
-        sys->writeMemory32(addr, (i == 0) ? 0xffffff : (addr - 4) & 0xffffff);
+        ram[(addr & (System::RAM_SIZE - 4)) / 4] = (i == 0) ? 0xffffff : (addr - 4) & 0xffffff;
     }
 
+    sys->ramWritten((addr + 4) & (System::RAM_SIZE - 4), wordCount * 4);
+
     irqFlag = true;
     control.enabled = CHCR::Enabled::completed;
 }
@@ -1,12 +1,11 @@
 #include "dma_channel.h"
 #include <fmt/core.h>
+#include <algorithm>
 #include <magic_enum.hpp>
-#include "config.h"
 #include "system.h"
-#include <unordered_set>
 
 namespace device::dma {
-DMAChannel::DMAChannel(Channel channel, System* sys) : channel(channel), sys(sys) { verbose = config.debug.log.dma; }
+DMAChannel::DMAChannel(Channel channel, System* sys) : channel(channel), sys(sys) { verbose = sys->config.debug.log.dma; }
 
 DMAChannel::~DMAChannel() {}
 
@@ -14,6 +13,14 @@ uint32_t DMAChannel::readDevice() { return 0; }
 
 void DMAChannel::writeDevice(uint32_t data) { (void)data; }
 
+void DMAChannel::readDeviceBlock(uint32_t* data, size_t words) {
+    for (size_t i = 0; i < words; i++) data[i] = readDevice();
+}
+
+void DMAChannel::writeDeviceBlock(const uint32_t* data, size_t words) {
+    for (size_t i = 0; i < words; i++) writeDevice(data[i]);
+}
+
 uint8_t DMAChannel::read(uint32_t address) {
     if (address < 0x4) return baseAddress._byte[address];
     if (address >= 0x4 && address < 0x8) return count._byte[address - 4];
@@ -31,18 +38,74 @@ void DMAChannel::write(uint32_t address, uint8_t data) {
         control._byte[address - 8] = data;
         maskControl();
 
-        if (address == 0xb) {
-            if (!sys->dma->isChannelEnabled(channel)) return;
-            if (control.syncMode == CHCR::SyncMode::block && control.startTrigger != CHCR::StartTrigger::manual) return;
-            if (control.enabled != CHCR::Enabled::start) return;
+        if (address == 0xb) controlWritten();
+    }
+}
+
+uint32_t DMAChannel::read32(uint32_t address) {
+    if (address == 0x0) return baseAddress._reg;
+    if (address == 0x4) return count._reg;
+    if (address == 0x8) return control._reg;
+    return 0;
+}
 
-            startTransfer();
-        }
+void DMAChannel::write32(uint32_t address, uint32_t data) {
+    if (address == 0x0) {
+        baseAddress._reg = data & 0xffffff;
+    } else if (address == 0x4) {
+        count._reg = data;
+    } else if (address == 0x8) {
+        control._reg = data;
+        maskControl();
+        controlWritten();
     }
 }
 
+// Transfer is started when upper byte of CHCR is written
+void DMAChannel::controlWritten() {
+    if (!sys->dma->isChannelEnabled(channel)) return;
+    if (control.syncMode == CHCR::SyncMode::block && control.startTrigger != CHCR::StartTrigger::manual) return;
+    if (control.enabled != CHCR::Enabled::start) return;
+
+    Profiler::Scope scope(sys->profiler, Profiler::Section::dma);
+    startTransfer();
+}
+
 void DMAChannel::maskControl() { control._reg &= ~CHCR::MASK; }
 
+uint32_t DMAChannel::transfer(uint32_t addr, size_t words, int step) {
+    bool toRam = control.direction == CHCR::Direction::toRam;
+
+    // Backward transfers are rare - they go through memory bus word by word
+    if (step < 0) {
+        for (size_t i = 0; i < words; i++, addr += step) {
+            if (toRam) {
+                sys->writeMemory32(addr, readDevice());
+            } else {
+                writeDevice(sys->readMemory32(addr));
+            }
+        }
+        return addr;
+    }
+
+    // DMA sees only RAM, span is split where it wraps around its end
+    while (words > 0) {
+        uint32_t offset = addr & (System::RAM_SIZE - 4);
+        size_t n = std::min<size_t>(words, (System::RAM_SIZE - offset) / 4);
+        auto* span = reinterpret_cast<uint32_t*>(sys->ram.data() + offset);
+
+        if (toRam) {
+            readDeviceBlock(span, n);
+            sys->ramWritten(offset, n * 4);
+        } else {
+            writeDeviceBlock(span, n);
+        }
+        addr += n * 4;
+        words -= n;
+    }
+    return addr;
+}
+
 void DMAChannel::startTransfer() {
     using namespace magic_enum;
 
@@ -56,15 +119,7 @@ void DMAChannel::startTransfer() {
             fmt::print("[DMA{}] {:<8} {} RAM @ 0x{:08x}, {}, count: 0x{:04x}\n", (int)channel, enum_name(channel), control.dir(), addr,
                        enum_name(control.syncMode), (int)count.syncMode0.wordCount);
         }
-        if (control.direction == CHCR::Direction::fromRam) {
-            for (size_t i = 0; i < count.syncMode0.wordCount; i++, addr += step) {
-                writeDevice(sys->readMemory32(addr));
-            }
-        } else if (control.direction == CHCR::Direction::toRam) {
-            for (size_t i = 0; i < count.syncMode0.wordCount; i++, addr += step) {
-                sys->writeMemory32(addr, readDevice());
-            }
-        }
+        transfer(addr, count.syncMode0.wordCount, step);
         control.enabled = CHCR::Enabled::stop;
     } else if (control.syncMode == CHCR::SyncMode::sync) {
         int blockCount = count.syncMode1.blockCount;
@@ -77,54 +132,14 @@ void DMAChannel::startTransfer() {
         }
 
         // TODO: Execute sync with chopping
-        if (control.direction == CHCR::Direction::toRam) {
-            for (int block = 0; block < blockCount; block++) {
-                for (int i = 0; i < blockSize; i++, addr += step) {
-                    sys->writeMemory32(addr, readDevice());
-                }
-            }
-        } else if (control.direction == CHCR::Direction::fromRam) {
-            for (int block = 0; block < blockCount; block++) {
-                for (int i = 0; i < blockSize; i++, addr += step) {
-                    writeDevice(sys->readMemory32(addr));
-                }
-            }
-        }
+        // Blocks are contiguous in RAM - whole transfer is a single span
+        addr = transfer(addr, (size_t)blockCount * blockSize, step);
         // TODO: Need proper Chopping implementation for SPU READ to work
         baseAddress.address = addr;
         count.syncMode1.blockCount = 0;
     } else if (control.syncMode == CHCR::SyncMode::linkedList) {
-        if (verbose) {
-            fmt::print("[DMA{}] {:<8} {} RAM @ 0x{:08x}, {}\n", (int)channel, enum_name(channel), control.dir(), addr,
-                       enum_name(control.syncMode));
-        }
-
-        std::unordered_set<uint32_t> visited;
-        for (;;) {
-            uint32_t blockInfo = sys->readMemory32(addr);
-            int commandCount = blockInfo >> 24;
-            int nextAddr = blockInfo & 0xffffff;
-
-            if (verbose >= 2) {
-                fmt::print("[DMA{}] {:<8} {} RAM @ 0x{:08x}, {}, count: {}, nextAddr: 0x{:08x}\n", (int)channel, enum_name(channel),
-                           control.dir(), addr, enum_name(control.syncMode), commandCount, nextAddr);
-            }
-
-            addr += step;
-            for (int i = 0; i < commandCount; i++, addr += step) {
-                writeDevice(sys->readMemory32(addr));
-            }
-
-            addr = nextAddr;
-            if (addr == 0xffffff || addr == 0) break;
-
-            if (visited.find(addr) != visited.end()) {
-                fmt::print("[DMA{}] GPU DMA transfer loop detected, breaking.\n", (int)channel);
-                break;
-            }
-            visited.insert(addr);
-        }
-        baseAddress.address = addr;
+        // Only GPU channel supports linked list mode (see DMA2Channel)
+        fmt::print("[DMA{}] {:<8} linked list mode not supported\n", (int)channel, enum_name(channel));
     }
 
     irqFlag = true;
@@ -89,8 +89,14 @@ class DMAChannel {
 
     virtual uint32_t readDevice();
     virtual void writeDevice(uint32_t data);
+    // Bulk endpoints for block and sync transfers, default implementations go word by word
+    virtual void readDeviceBlock(uint32_t* data, size_t words);
+    virtual void writeDeviceBlock(const uint32_t* data, size_t words);
     virtual void maskControl();
     virtual void startTransfer();
+    void controlWritten();
+    // Moves words between RAM and device, returns address after the last word
+    uint32_t transfer(uint32_t addr, size_t count, int step);
 
    public:
     bool irqFlag = false;
@@ -99,6 +105,8 @@ class DMAChannel {
 
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
+    uint32_t read32(uint32_t address);
+    void write32(uint32_t address, uint32_t data);
 
     template <class Archive>
     void serialize(Archive& ar) {
@@ -0,0 +1,158 @@
+#include "band_renderer.h"
+#include <algorithm>
+
+namespace gpu {
+
+namespace {
+// Palette rasterizer loads into cache for the primitive (mirrors checks done before loadClutCacheIfRequired)
+bool usedPalette(const DrawQueue::Entry& entry, ivec2& pos, ColorDepth& depth) {
+    if (auto triangle = std::get_if<primitive::Triangle>(&entry.primitive)) {
+        const auto& v = triangle->v;
+        int area = (v[1].pos.x - v[0].pos.x) * (v[2].pos.y - v[0].pos.y) - (v[1].pos.y - v[0].pos.y) * (v[2].pos.x - v[0].pos.x);
+        if (area == 0) return false;
+        pos = triangle->clut;
+        depth = bitsToDepth(triangle->bits);
+    } else if (auto rect = std::get_if<primitive::Rect>(&entry.primitive)) {
+        if (rect->size.x >= 1024 || rect->size.y >= 512) return false;
+        pos = rect->clut;
+        depth = bitsToDepth(rect->bits);
+    } else {
+        return false;
+    }
+    return depth == ColorDepth::BIT_4 || depth == ColorDepth::BIT_8;
+}
+}  // namespace
+
+BandRenderer::BandRenderer(int threads) {
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&BandRenderer::work, this);
+    }
+}
+
+BandRenderer::~BandRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void BandRenderer::work() {
+    int seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+
+        drawBands();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) finished.notify_one();
+    }
+}
+
+void BandRenderer::drawBands() {
+    for (int band; (band = nextBand++) < BANDS;) {
+        drawBand(band);
+    }
+}
+
+void BandRenderer::loadPalette(ClutCache& cache, int source) const {
+    if (source == INITIAL_PALETTE) {
+        cache = initialClut;
+        return;
+    }
+
+    usedPalette((*entries)[source], cache.pos, cache.colorDepth);
+    int count = cache.colorDepth == ColorDepth::BIT_8 ? 256 : 16;
+    for (int i = 0; i < count; i++) {
+        cache.entries[i] = vram[cache.pos.y * VRAM_WIDTH + cache.pos.x + i];
+    }
+}
+
+void BandRenderer::drawBand(int band) {
+    const int top = band * BAND_HEIGHT;
+    const int bottom = top + BAND_HEIGHT - 1;
+
+    ClutCache cache;
+    int loaded = NO_PALETTE;
+    for (size_t i : bins[band]) {
+        int source = paletteSource[i];
+        if (source != NO_PALETTE && source != loaded) {
+            loadPalette(cache, source);
+            loaded = source;
+        }
+        (*entries)[i].draw(vram, cache, top, bottom);
+    }
+}
+
+void BandRenderer::draw(const DrawQueue& queue, uint16_t* vram, ClutCache& clutCache) {
+    const auto& entries = queue.getEntries();
+    if (entries.empty()) return;
+
+    // Primitive sampling its own output depends on pixel order, only the first one in batch can do that
+    size_t first = 0;
+    if (entries[0].samplesOwnOutput()) {
+        if (entries[0].invalidateClut) clutCache.invalidate();
+        entries[0].draw(vram, clutCache);
+        first = 1;
+    }
+
+    // Palettes are not modified during the batch - it's enough to know which load every primitive would see
+    initialClut = clutCache;
+    paletteSource.assign(entries.size(), NO_PALETTE);
+    int source = INITIAL_PALETTE;
+    for (auto& bin : bins) bin.clear();
+
+    for (size_t i = first; i < entries.size(); i++) {
+        const auto& entry = entries[i];
+        if (entry.invalidateClut) clutCache.invalidate();
+
+        ivec2 pos;
+        ColorDepth depth;
+        if (usedPalette(entry, pos, depth)) {
+            if (depth > clutCache.colorDepth || pos != clutCache.pos) {
+                clutCache.pos = pos;
+                clutCache.colorDepth = depth;
+                source = (int)i;
+            }
+            paletteSource[i] = source;
+        }
+
+        int firstBand = std::max(entry.bounds.top, 0) / BAND_HEIGHT;
+        int lastBand = std::min(entry.bounds.bottom - 1, VRAM_HEIGHT - 1) / BAND_HEIGHT;
+        for (int band = firstBand; band <= lastBand; band++) {
+            bins[band].push_back(i);
+        }
+    }
+
+    this->entries = &entries;
+    this->vram = vram;
+    nextBand = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    drawBands();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return busy == 0; });
+    }
+
+    // Cache state after the last primitive, position stays invalidated if GP0(01) came after the last load
+    if (source != INITIAL_PALETTE) {
+        const ivec2 pos = clutCache.pos;
+        loadPalette(clutCache, source);
+        clutCache.pos = pos;
+    }
+}
+
+}  // namespace gpu
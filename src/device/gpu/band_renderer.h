@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "draw_queue.h"
+
+namespace gpu {
+
+// Rasterizes queued primitives on worker threads. VRAM is split into horizontal bands, every band is drawn
+// by single thread in submission order - output is identical to serial drawing as long as no primitive
+// samples VRAM written by other one from the same batch (see DrawQueue::samplingConflicts).
+class BandRenderer {
+   public:
+    static const int BAND_HEIGHT = 8;
+    static const int BANDS = VRAM_HEIGHT / BAND_HEIGHT;
+
+    // Calling thread takes part in drawing, threads - 1 workers are started
+    explicit BandRenderer(int threads);
+    ~BandRenderer();
+
+    int getThreads() const { return (int)workers.size() + 1; }
+
+    // Draws queued primitives, clutCache ends up in the same state as after drawing them one by one
+    void draw(const DrawQueue& queue, uint16_t* vram, ClutCache& clutCache);
+
+   private:
+    static constexpr int NO_PALETTE = -2;
+    static constexpr int INITIAL_PALETTE = -1;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    int generation = 0;
+    int busy = 0;
+    bool quit = false;
+
+    // Current batch
+    const std::vector<DrawQueue::Entry>* entries = nullptr;
+    uint16_t* vram = nullptr;
+    std::array<std::vector<size_t>, BANDS> bins;
+    // Entry whose palette load is in cache when primitive is drawn (INITIAL_PALETTE - cache from before the batch)
+    std::vector<int> paletteSource;
+    ClutCache initialClut;
+    std::atomic<int> nextBand{0};
+
+    void work();
+    void drawBands();
+    void drawBand(int band);
+    void loadPalette(ClutCache& cache, int source) const;
+};
+
+}  // namespace gpu
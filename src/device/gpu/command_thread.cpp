@@ -0,0 +1,77 @@
+#include "command_thread.h"
+#include <array>
+#include "gpu.h"
+
+namespace gpu {
+
+CommandThread::CommandThread(GPU* gpu) : gpu(gpu) { thread = std::thread(&CommandThread::work, this); }
+
+CommandThread::~CommandThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void CommandThread::push(const uint32_t* words, size_t count) {
+    pushed += count;
+    for (;;) {
+        size_t n = ring.push(words, count);
+        words += n;
+        count -= n;
+        wakeIfSleeping();
+        if (count == 0) return;
+
+        // Ring is full - GPU thread is busy, let it catch up
+        std::this_thread::yield();
+    }
+}
+
+void CommandThread::synchronize() {
+    if (executed.load(std::memory_order_acquire) == pushed) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] { return executed.load(std::memory_order_acquire) == pushed; });
+}
+
+void CommandThread::wakeIfSleeping() {
+    // Pairs with fence in work() - either sleeping flag is seen here, or pushed words are seen before GPU thread waits
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!sleeping.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    wake.notify_one();
+}
+
+void CommandThread::work() {
+    std::array<uint32_t, CHUNK_SIZE> chunk;
+    for (;;) {
+        size_t count = ring.pop(chunk.data(), chunk.size());
+        if (count > 0) {
+            gpu->executePackets(chunk.data(), count);
+            executed.fetch_add(count, std::memory_order_release);
+            continue;
+        }
+
+        // Lock makes sure producer is either already waiting or sees updated counter
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        idle.notify_all();
+
+        // Commands often come in bursts (word by word writes to GP0), sleeping between them would cost more than drawing
+        for (int i = 0; i < SPIN_COUNT && ring.empty(); i++) std::this_thread::yield();
+        if (!ring.empty()) continue;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake.wait(lock, [&] { return quit || !ring.empty(); });
+        sleeping.store(false, std::memory_order_relaxed);
+        if (quit && ring.empty()) return;
+    }
+}
+
+}  // namespace gpu
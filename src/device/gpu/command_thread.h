@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "utils/spsc_queue.h"
+
+namespace gpu {
+
+class GPU;
+
+// Executes GP0 words on a dedicated thread. Emulation thread only copies them into lock-free ring -
+// GPU state modified by command execution can be accessed by it again after synchronize().
+class CommandThread {
+   public:
+    explicit CommandThread(GPU* gpu);
+    // Words left in the ring are executed before thread exits
+    ~CommandThread();
+
+    void push(const uint32_t* words, size_t count);
+    // Waits until every pushed word is executed
+    void synchronize();
+
+   private:
+    static const size_t RING_SIZE = 64 * 1024;
+    static const size_t CHUNK_SIZE = 1024;
+    static const int SPIN_COUNT = 64;  // Yields before going to sleep on empty ring
+
+    GPU* gpu;
+    SpscQueue<uint32_t, RING_SIZE> ring;
+    uint64_t pushed = 0;  // Accessed only by producer
+    std::atomic<uint64_t> executed{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;  // Words pushed to empty ring
+    std::condition_variable idle;  // Ring drained
+    std::atomic<bool> sleeping{false};
+    bool quit = false;
+    std::thread thread;
+
+    void work();
+    void wakeIfSleeping();
+};
+
+}  // namespace gpu
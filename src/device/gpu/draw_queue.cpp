@@ -0,0 +1,134 @@
+#include "draw_queue.h"
+#include <algorithm>
+
+namespace gpu {
+
+namespace {
+bool isEmpty(const Rect<int>& rect) { return rect.left >= rect.right || rect.top >= rect.bottom; }
+
+bool contains(const Rect<int>& outer, const Rect<int>& inner) {
+    return inner.left >= outer.left && inner.right <= outer.right && inner.top >= outer.top && inner.bottom <= outer.bottom;
+}
+
+bool overlaps(const Rect<int>& a, const Rect<int>& b) {
+    return !isEmpty(a) && !isEmpty(b) && a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+}  // namespace
+
+void DrawQueue::Entry::draw(uint16_t* vram, ClutCache& clutCache, int top, int bottom) const {
+    Render::Target target{vram, gp0_e1, gp0_e2, gp0_e6, drawingArea, &clutCache, top, bottom};
+    if (auto triangle = std::get_if<primitive::Triangle>(&primitive)) {
+        Render::drawTriangle(target, *triangle);
+    } else if (auto line = std::get_if<primitive::Line>(&primitive)) {
+        Render::drawLine(target, *line);
+    } else if (auto rect = std::get_if<primitive::Rect>(&primitive)) {
+        Render::drawRectangle(target, *rect);
+    }
+}
+
+bool DrawQueue::Entry::samplesOwnOutput() const { return overlaps(texture, bounds) || overlaps(clut, bounds); }
+
+void TileMask::add(const Rect<int>& rect) {
+    if (isEmpty(rect)) return;
+    for (int y = rect.top / TILE_SIZE; y <= (rect.bottom - 1) / TILE_SIZE; y++) {
+        for (int x = rect.left / TILE_SIZE; x <= (rect.right - 1) / TILE_SIZE; x++) {
+            tiles.set(y * COLUMNS + x);
+        }
+    }
+}
+
+bool TileMask::intersects(const Rect<int>& rect) const {
+    if (isEmpty(rect)) return false;
+    for (int y = rect.top / TILE_SIZE; y <= (rect.bottom - 1) / TILE_SIZE; y++) {
+        for (int x = rect.left / TILE_SIZE; x <= (rect.right - 1) / TILE_SIZE; x++) {
+            if (tiles.test(y * COLUMNS + x)) return true;
+        }
+    }
+    return false;
+}
+
+void DrawQueue::addReads(TileMask& mask, const Entry& entry) const {
+    mask.add(entry.texture);
+    mask.add(entry.clut);
+    if (entry.readsDestination) mask.add(entry.bounds);
+}
+
+void DrawQueue::rebuildMasks() {
+    written.clear();
+    read.clear();
+    sampled.clear();
+    for (const auto& entry : entries) {
+        written.add(entry.bounds);
+        addReads(read, entry);
+        sampled.add(entry.texture);
+        sampled.add(entry.clut);
+    }
+}
+
+void DrawQueue::clear() {
+    entries.clear();
+    written.clear();
+    read.clear();
+    sampled.clear();
+    invalidateClutPending = false;
+}
+
+void DrawQueue::push(Entry entry) {
+    if (isEmpty(entry.bounds)) return;
+
+    entry.invalidateClut = invalidateClutPending;
+    invalidateClutPending = false;
+
+    written.add(entry.bounds);
+    addReads(read, entry);
+    sampled.add(entry.texture);
+    sampled.add(entry.clut);
+    entries.push_back(std::move(entry));
+}
+
+bool DrawQueue::conflicts(const Rect<int>& reads, const Rect<int>& writes) const {
+    if (entries.empty()) return false;
+    return written.intersects(reads) || written.intersects(writes) || read.intersects(writes);
+}
+
+bool DrawQueue::samplingConflicts(const Entry& entry) const {
+    if (entries.empty()) return false;
+    return entry.samplesOwnOutput() || written.intersects(entry.texture) || written.intersects(entry.clut)
+           || sampled.intersects(entry.bounds);
+}
+
+void DrawQueue::discardCovered(const Rect<int>& fill) {
+    if (entries.empty() || !written.intersects(fill)) return;
+
+    // Walk from the newest primitive, collecting areas that later primitives sample
+    TileMask readLater;
+    std::vector<bool> discard(entries.size(), false);
+    bool anyDiscarded = false;
+    for (size_t i = entries.size(); i-- > 0;) {
+        const auto& entry = entries[i];
+        if (contains(fill, entry.bounds) && !readLater.intersects(entry.bounds)) {
+            discard[i] = anyDiscarded = true;
+            continue;
+        }
+        addReads(readLater, entry);
+    }
+    if (!anyDiscarded) return;
+
+    // Palette cache invalidation of dropped primitive moves to the next one kept
+    std::vector<Entry> kept;
+    bool invalidate = false;
+    for (size_t i = 0; i < entries.size(); i++) {
+        invalidate |= entries[i].invalidateClut;
+        if (discard[i]) continue;
+
+        kept.push_back(std::move(entries[i]));
+        kept.back().invalidateClut = invalidate;
+        invalidate = false;
+    }
+    invalidateClutPending |= invalidate;
+
+    entries = std::move(kept);
+    rebuildMasks();
+}
+
+}  // namespace gpu
@@ -0,0 +1,86 @@
+#pragma once
+#include <bitset>
+#include <variant>
+#include <vector>
+#include "gpu.h"
+#include "primitive.h"
+#include "registers.h"
+#include "render/render.h"
+
+namespace gpu {
+
+// Coarse set of VRAM areas, 16x16 pixel tiles
+class TileMask {
+    static const int TILE_SIZE = 16;
+    static const int COLUMNS = VRAM_WIDTH / TILE_SIZE;
+    static const int ROWS = VRAM_HEIGHT / TILE_SIZE;
+
+    std::bitset<COLUMNS * ROWS> tiles;
+
+   public:
+    // Rect is [left, right) x [top, bottom), clipped to VRAM
+    void add(const Rect<int>& rect);
+    bool intersects(const Rect<int>& rect) const;
+
+    bool intersects(const TileMask& other) const { return (tiles & other.tiles).any(); }
+    void clear() { tiles.reset(); }
+};
+
+// Primitives waiting for software rasterization (used with frame skip).
+// Rasterizing is postponed until VRAM they touch is observed or overwritten,
+// primitives completely covered by later fill are never drawn.
+class DrawQueue {
+   public:
+    struct Entry {
+        std::variant<primitive::Triangle, primitive::Line, primitive::Rect> primitive;
+
+        // Drawing state used by rasterizer
+        GP0_E1 gp0_e1;
+        GP0_E2 gp0_e2;
+        GP0_E6 gp0_e6;
+        Rect<int16_t> drawingArea;
+
+        Rect<int> bounds;   // Area written (conservative)
+        Rect<int> texture;  // Texture page area sampled, empty if untextured
+        Rect<int> clut;     // Palette read, empty if not paletted
+        bool readsDestination;
+        bool invalidateClut = false;  // GP0(0x01) received before this primitive was queued
+
+        // Rasterizes rows [top, bottom] of primitive with its drawing state
+        void draw(uint16_t* vram, ClutCache& clutCache, int top = 0, int bottom = VRAM_HEIGHT - 1) const;
+        bool samplesOwnOutput() const;
+    };
+
+   private:
+    std::vector<Entry> entries;
+    TileMask written;
+    TileMask read;
+    TileMask sampled;  // Texture and palette reads only
+    bool invalidateClutPending = false;
+
+    void addReads(TileMask& mask, const Entry& entry) const;
+    void rebuildMasks();
+
+   public:
+    bool empty() const { return entries.empty(); }
+    const std::vector<Entry>& getEntries() const { return entries; }
+    void clear();
+
+    void push(Entry entry);
+
+    // Palette cache invalidation has to be replayed in order with queued primitives
+    void invalidateClut() { invalidateClutPending = true; }
+    bool isClutInvalidationPending() const { return invalidateClutPending; }
+
+    // True if operation reading and writing given areas (immediately) has to wait for queued primitives
+    bool conflicts(const Rect<int>& reads, const Rect<int>& writes) const;
+
+    // Drops primitives whose output will be overwritten by fill and is not sampled by other queued primitive
+    void discardCovered(const Rect<int>& fill);
+
+    // True if entry samples VRAM written by queued primitives or writes VRAM they sample.
+    // Parallel rasterization of queue requires sampled VRAM to stay unchanged.
+    bool samplingConflicts(const Entry& entry) const;
+};
+
+}  // namespace gpu
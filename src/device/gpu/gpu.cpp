@@ -1,7 +1,10 @@
 #include "gpu.h"
 #include <fmt/core.h>
+#include <algorithm>
 #include <cassert>
-#include "config.h"
+#include "band_renderer.h"
+#include "command_thread.h"
+#include "draw_queue.h"
 #include "render/render.h"
 #include "system.h"
 #include "utils/file.h"
@@ -12,20 +15,110 @@
 #include <stb_image_write.h>
 
 namespace gpu {
-GPU::GPU(System* sys) : sys(sys) {
-    busToken = bus.listen<Event::Config::Graphics>([&](auto) { reload(); });
-    reload();
+namespace {
+// VRAM area sampled by texture page (texture window is not taken into account)
+Rect<int> textureArea(ivec2 texpage, int bits) {
+    if (bits == 0) return {};
+    int width = bits == 4 ? 64 : (bits == 8 ? 128 : 256);
+    if (texpage.x + width > VRAM_WIDTH) return {0, texpage.y, VRAM_WIDTH, std::min(texpage.y + 256, VRAM_HEIGHT)};
+    return {texpage.x, texpage.y, texpage.x + width, std::min(texpage.y + 256, VRAM_HEIGHT)};
+}
+
+Rect<int> clutArea(ivec2 clut, int bits) {
+    if (bits != 4 && bits != 8) return {};
+    int entries = bits == 8 ? 256 : 16;
+    // Palette crossing right edge of VRAM continues in next line
+    if (clut.x + entries > VRAM_WIDTH) return {0, clut.y, VRAM_WIDTH, std::min(clut.y + 2, VRAM_HEIGHT)};
+    return {clut.x, clut.y, clut.x + entries, clut.y + 1};
+}
+
+// Copy texture bits from Polygon draw command to E1 register
+// texpagex, texpagey, semi-transparency, texture disable bits
+void copyTexpageToE1(GP0_E1& e1, uint16_t texpage, bool textureDisableAllowed) {
+    const uint32_t E1_MASK = 0b00001001'11111111;
+
+    uint16_t newBits = texpage & E1_MASK;
+    if (!textureDisableAllowed) {
+        newBits &= ~(1 << 11);
+    }
+
+    e1._reg &= ~E1_MASK;
+    e1._reg |= newBits;
+}
+
+// Index of polygon argument with texture page (second vertex attributes)
+int texpageArgument(PolygonArgs arg) { return arg.gouraudShading ? 5 : 4; }
+
+Rect<int> copyArea(int x, int y, int w, int h) {
+    // Copies wrap around VRAM edges
+    if (x + w > VRAM_WIDTH) x = 0, w = VRAM_WIDTH;
+    if (y + h > VRAM_HEIGHT) y = 0, h = VRAM_HEIGHT;
+    return {x, y, x + w, y + h};
+}
+}  // namespace
+
+GPU::GPU(System* sys) : sys(sys), drawQueue(std::make_unique<DrawQueue>()) {
+    busToken = sys->bus->listen<Event::Config::Graphics>([&](auto) { reload(); });
     reset();
+    reload();
 }
 
-GPU::~GPU() { bus.unlistenAll(busToken); }
+GPU::~GPU() {
+    setCommandThread(false);
+    sys->bus->unlistenAll(busToken);
+}
 
 void GPU::reload() {
+    synchronize();
+    const auto& config = sys->config;
     verbose = config.debug.log.gpu;
     forceNtsc = config.options.graphics.forceNtsc;
     auto mode = config.options.graphics.renderingMode;
     softwareRendering = (mode & RenderingMode::software) != 0;
     hardwareRendering = (mode & RenderingMode::hardware) != 0;
+    setFrameSkip(config.options.graphics.frameSkip);
+    setRendererThreads(config.options.graphics.rendererThreads);
+    setCommandThread(config.options.graphics.gpuThread);
+}
+
+void GPU::setFrameSkip(int frames) {
+    frames = std::max(0, frames);
+    if (frames == frameSkip) return;
+
+    synchronize();
+    frameSkip = frames;
+    if (frameSkip == 0) {
+        frameSkipped = false;
+        flushDeferred();
+    }
+}
+
+void GPU::setRendererThreads(int threads) {
+    if (threads <= 1) threads = 0;
+    if (threads == (bandRenderer ? bandRenderer->getThreads() : 0)) return;
+
+    flushDeferred();
+    bandRenderer = threads > 0 ? std::make_unique<BandRenderer>(threads) : nullptr;
+}
+
+void GPU::setCommandThread(bool enabled) {
+    if (enabled == (commandThread != nullptr)) return;
+
+    synchronize();
+    syncSubmitted();
+    commandThread = enabled ? std::make_unique<CommandThread>(this) : nullptr;
+}
+
+void GPU::synchronize() {
+    if (!commandThread) return;
+    commandThread->synchronize();
+    raisePendingIrq();
+}
+
+void GPU::raisePendingIrq() {
+    if (irqPending.load(std::memory_order_relaxed) && irqPending.exchange(false)) {
+        sys->interrupt->trigger(interrupt::IrqNumber::GPU);
+    }
 }
 
 void GPU::reset() {
@@ -50,7 +143,46 @@ void GPU::reset() {
 
     gp0_e6._reg = 0;
 
-    clutCachePos = ivec2(-1, -1);
+    invalidateClutCache();
+}
+
+void GPU::invalidateClutCache() {
+    if (!drawQueue->empty()) {
+        drawQueue->invalidateClut();
+        return;
+    }
+    clutCache.invalidate();
+}
+
+Rect<int> GPU::drawingBounds(int left, int top, int right, int bottom) const {
+    return {
+        std::max({left, (int)drawingArea.left, 0}),
+        std::max({top, (int)drawingArea.top, 0}),
+        std::min({right + 1, drawingArea.right + 1, VRAM_WIDTH}),
+        std::min({bottom + 1, drawingArea.bottom + 1, VRAM_HEIGHT}),
+    };
+}
+
+void GPU::settleDeferred(const Rect<int>& reads, const Rect<int>& writes) {
+    if (drawQueue->conflicts(reads, writes)) drawDeferred();
+}
+
+void GPU::flushDeferred() {
+    synchronize();
+    drawDeferred();
+}
+
+void GPU::drawDeferred() {
+    if (bandRenderer) {
+        bandRenderer->draw(*drawQueue, vram.data(), clutCache);
+    } else {
+        for (const auto& entry : drawQueue->getEntries()) {
+            if (entry.invalidateClut) clutCache.invalidate();
+            entry.draw(vram.data(), clutCache);
+        }
+    }
+    if (drawQueue->isClutInvalidationPending()) clutCache.invalidate();
+    drawQueue->clear();
 }
 
 void GPU::drawTriangle(const primitive::Triangle& triangle) {
@@ -80,8 +212,21 @@ void GPU::drawTriangle(const primitive::Triangle& triangle) {
         }
     }
 
-    if (softwareRendering) {
-        Render::drawTriangle(this, triangle);
+    if (softwareRendering && isDeferring()) {
+        DrawQueue::Entry entry{triangle, gp0_e1, gp0_e2, gp0_e6, drawingArea};
+        entry.bounds = drawingBounds(                                               //
+            std::min({triangle.v[0].pos.x, triangle.v[1].pos.x, triangle.v[2].pos.x}),  //
+            std::min({triangle.v[0].pos.y, triangle.v[1].pos.y, triangle.v[2].pos.y}),  //
+            std::max({triangle.v[0].pos.x, triangle.v[1].pos.x, triangle.v[2].pos.x}),  //
+            std::max({triangle.v[0].pos.y, triangle.v[1].pos.y, triangle.v[2].pos.y})   //
+        );
+        entry.texture = textureArea(triangle.texpage, triangle.bits);
+        entry.clut = clutArea(triangle.clut, triangle.bits);
+        entry.readsDestination = triangle.isSemiTransparent || gp0_e6.checkMaskBeforeDraw;
+        if (bandRenderer && drawQueue->samplingConflicts(entry)) drawDeferred();
+        drawQueue->push(std::move(entry));
+    } else if (softwareRendering) {
+        Render::drawTriangle(Render::target(this), triangle);
     }
 }
 
@@ -125,8 +270,15 @@ void GPU::drawLine(const primitive::Line& line) {
         pushVertex(p[1].x - b.x, p[1].y - b.y, c[1]);
     }
 
-    if (softwareRendering) {
-        Render::drawLine(this, line);
+    if (softwareRendering && isDeferring()) {
+        DrawQueue::Entry entry{line, gp0_e1, gp0_e2, gp0_e6, drawingArea};
+        entry.bounds = drawingBounds(std::min(line.pos[0].x, line.pos[1].x), std::min(line.pos[0].y, line.pos[1].y),
+                                     std::max(line.pos[0].x, line.pos[1].x), std::max(line.pos[0].y, line.pos[1].y));
+        entry.readsDestination = line.isSemiTransparent || gp0_e6.checkMaskBeforeDraw;
+        if (bandRenderer && drawQueue->samplingConflicts(entry)) drawDeferred();
+        drawQueue->push(std::move(entry));
+    } else if (softwareRendering) {
+        Render::drawLine(Render::target(this), line);
     }
 }
 
@@ -187,8 +339,16 @@ void GPU::drawRectangle(const primitive::Rect& rect) {
         }
     }
 
-    if (softwareRendering) {
-        Render::drawRectangle(this, rect);
+    if (softwareRendering && isDeferring()) {
+        DrawQueue::Entry entry{rect, gp0_e1, gp0_e2, gp0_e6, drawingArea};
+        entry.bounds = drawingBounds(rect.pos.x, rect.pos.y, rect.pos.x + rect.size.x - 1, rect.pos.y + rect.size.y - 1);
+        entry.texture = textureArea(rect.texpage, rect.bits);
+        entry.clut = clutArea(rect.clut, rect.bits);
+        entry.readsDestination = rect.isSemiTransparent || gp0_e6.checkMaskBeforeDraw;
+        if (bandRenderer && drawQueue->samplingConflicts(entry)) drawDeferred();
+        drawQueue->push(std::move(entry));
+    } else if (softwareRendering) {
+        Render::drawRectangle(Render::target(this), rect);
     }
 }
 
@@ -207,6 +367,10 @@ void GPU::cmdFillRectangle() {
 
     uint32_t color = to15bit(arguments[0] & 0xffffff);
 
+    Rect<int> area{startX, startY, endX, endY};
+    drawQueue->discardCovered(area);
+    settleDeferred({}, area);
+
     // Note: not sure if coords should include last column and row
     for (int y = startY; y < endY; y++) {
         for (int x = startX; x < endX; x++) {
@@ -289,17 +453,7 @@ void GPU::cmdPolygon(PolygonArgs arg) {
         triangle.clut.y = tex.getClutY();
         triangle.transparency = tex.semiTransparencyBlending();
 
-        // Copy texture bits from Polygon draw command to E1 register
-        // texpagex, texpagey, semi-transparency, texture disable bits
-        const uint32_t E1_MASK = 0b00001001'11111111;
-
-        uint16_t newBits = (tex.texpage >> 16) & E1_MASK;
-        if (!textureDisableAllowed) {
-            newBits &= ~(1 << 11);
-        }
-
-        gp0_e1._reg &= ~E1_MASK;
-        gp0_e1._reg |= newBits;
+        copyTexpageToE1(gp0_e1, tex.texpage >> 16, textureDisableAllowed);
     }
 
     triangle.assureCcw();
@@ -431,6 +585,8 @@ void GPU::cmdCpuToVram1() {
     endX = startX + MaskCopy::w(arguments[2] & 0xffff);
     endY = startY + MaskCopy::h((arguments[2] & 0xffff0000) >> 16);
 
+    settleDeferred({}, copyArea(startX, startY, endX - startX, endY - startY));
+
     cmd = Command::CopyCpuToVram2;
     argumentCount = 1;
     currentArgument = 0;
@@ -481,6 +637,8 @@ void GPU::cmdVramToCpu() {
     endX = startX + MaskCopy::w(arguments[2] & 0xffff);
     endY = startY + MaskCopy::h((arguments[2] & 0xffff0000) >> 16);
 
+    settleDeferred(copyArea(startX, startY, endX - startX, endY - startY), {});
+
     cmd = Command::None;
 }
 
@@ -521,6 +679,8 @@ void GPU::cmdVramToVram() {
     int w = MaskCopy::w(arguments[3] & 0xffff);
     int h = MaskCopy::h((arguments[3] & 0xffff0000) >> 16);
 
+    settleDeferred(copyArea(srcX, srcY, w, h), copyArea(dstX, dstY, w, h));
+
     // Note: VramToVram copy is always Top-to-Bottom
     // but it might be Left-to-Right or Right-to-Left depending whether srcX < dstX
     // See gpu/vram-to-vram-overlap test
@@ -537,6 +697,16 @@ void GPU::cmdVramToVram() {
 }
 
 uint32_t GPU::getStat() {
+    // GPU thread can be behind, GP0 bits come from decoded submitted words (read mode only after executing VRAM->CPU)
+    if (commandThread && submitted.vramRead) {
+        synchronize();
+        syncSubmitted();
+    }
+    const GP0_E1 gp0_e1 = commandThread ? submitted.gp0_e1 : this->gp0_e1;
+    const GP0_E6 gp0_e6 = commandThread ? submitted.gp0_e6 : this->gp0_e6;
+    const bool irqRequest = commandThread ? submitted.irqRequest : this->irqRequest;
+    const Command cmd = commandThread ? submitted.cmd : this->cmd;
+
     uint32_t GPUSTAT = 0;
     uint8_t dataRequest = 0;
     if (dmaDirection == 0)
@@ -575,8 +745,12 @@ uint32_t GPU::getStat() {
 uint32_t GPU::read(uint32_t address) {
     int reg = address & 0xfffffffc;
     if (reg == 0) {
+        synchronize();
         if (readMode == ReadMode::Vram) {
-            return readVramData();
+            uint32_t data = readVramData();
+            // Transfer position is shared with CPU->VRAM transfer, packet tracked for GPUSTAT might have moved
+            if (commandThread) syncSubmitted();
+            return data;
         } else {
             return readData;
         }
@@ -593,8 +767,113 @@ uint32_t GPU::read(uint32_t address) {
 }
 
 void GPU::write(uint32_t address, uint32_t data) {
-    if (address == 0) writeGP0(data);
-    if (address == 4) writeGP1(data);
+    Profiler::Scope scope(sys->profiler, Profiler::Section::gpu);
+    if (address == 0) {
+        if (commandThread) {
+            trackSubmitted(&data, 1);
+            commandThread->push(&data, 1);
+        } else {
+            writeGP0(data);
+        }
+    }
+    if (address == 4) {
+        // GP1 is rare, most of its commands change state GP0 execution depends on
+        synchronize();
+        writeGP1(data);
+        syncSubmitted();
+    }
+}
+
+void GPU::syncSubmitted() {
+    submitted.gp0_e1 = gp0_e1;
+    submitted.gp0_e6 = gp0_e6;
+    submitted.irqRequest = irqRequest;
+    submitted.cmd = cmd;
+    submitted.polyLine = cmd == Command::Line && LineArgs(command).polyLine;
+    submitted.vramRead = false;
+    submitted.texpageRemaining = 0;
+    if (cmd == Command::CopyCpuToVram2) {
+        // Rows below current one (GPUREAD shares transfer position and can move it past the last row)
+        int pixels = std::max(endY - currY - 1, 0) * (endX - startX) + (endX - currX);
+        submitted.remaining = (pixels + 1) / 2;
+    } else {
+        submitted.remaining = argumentCount - currentArgument;
+    }
+    if (cmd == Command::Polygon && PolygonArgs(command).isTextureMapped) {
+        int index = texpageArgument(command);
+        submitted.texpageRemaining = argumentCount - index;
+        if (currentArgument > index) submitted.texpage = arguments[index];
+    }
+}
+
+// Follows packet boundaries of writeGP0 without executing anything
+void GPU::trackSubmitted(const uint32_t* data, size_t words) {
+    auto& s = submitted;
+    for (size_t i = 0; i < words; i++) {
+        if (s.cmd == Command::None) {
+            uint8_t command = data[i] >> 24;
+            s.polyLine = false;
+            if (command == 0x02) {
+                s.cmd = Command::FillRectangle;
+                s.remaining = 2;
+            } else if (command >= 0x20 && command < 0x40) {
+                PolygonArgs arg(command);
+                s.cmd = Command::Polygon;
+                s.remaining = arg.getArgumentCount();
+                s.texpageRemaining = arg.isTextureMapped ? s.remaining + 1 - texpageArgument(arg) : 0;
+            } else if (command >= 0x40 && command < 0x60) {
+                s.cmd = Command::Line;
+                s.remaining = LineArgs(command).getArgumentCount();
+                s.polyLine = LineArgs(command).polyLine;
+            } else if (command >= 0x60 && command < 0x80) {
+                s.cmd = Command::Rectangle;
+                s.remaining = RectangleArgs(command).getArgumentCount();
+            } else if (command >= 0x80 && command <= 0x9f) {
+                s.cmd = Command::CopyVramToVram;
+                s.remaining = 3;
+            } else if (command >= 0xa0 && command <= 0xbf) {
+                s.cmd = Command::CopyCpuToVram1;
+                s.remaining = 2;
+            } else if (command >= 0xc0 && command <= 0xdf) {
+                s.cmd = Command::CopyVramToCpu;
+                s.remaining = 2;
+            } else if (command == 0xe1) {
+                s.gp0_e1._reg = data[i];
+                if (!textureDisableAllowed) s.gp0_e1.textureDisable = false;
+            } else if (command == 0xe6) {
+                s.gp0_e6._reg = data[i];
+            } else if (command == 0x1f) {
+                s.irqRequest = true;
+            }
+            continue;
+        }
+
+        // Polyline ends with terminator only
+        if (s.cmd == Command::Line && s.polyLine) {
+            if ((data[i] & 0xf000f000) == 0x50005000) s.cmd = Command::None;
+            continue;
+        }
+
+        // Rest of the packet is skipped at once
+        int n = (int)std::min<size_t>(std::max(s.remaining, 1), words - i);
+        if (s.cmd == Command::Polygon && s.remaining >= s.texpageRemaining && s.remaining - n < s.texpageRemaining) {
+            s.texpage = data[i + s.remaining - s.texpageRemaining];
+        }
+        i += n - 1;
+        s.remaining -= n;
+        if (s.remaining > 0) continue;
+
+        if (s.cmd == Command::Polygon && s.texpageRemaining > 0) {
+            copyTexpageToE1(s.gp0_e1, s.texpage >> 16, textureDisableAllowed);
+        }
+        if (s.cmd == Command::CopyCpuToVram1) {
+            s.cmd = Command::CopyCpuToVram2;
+            s.remaining = (MaskCopy::w(data[i] & 0xffff) * MaskCopy::h(data[i] >> 16) + 1) / 2;
+        } else {
+            if (s.cmd == Command::CopyVramToCpu) s.vramRead = true;
+            s.cmd = Command::None;
+        }
+    }
 }
 
 void GPU::writeGP0(uint32_t data) {
@@ -611,7 +890,7 @@ void GPU::writeGP0(uint32_t data) {
             }
         } else if (command == 0x01) {
             // Clear Cache
-            clutCachePos = ivec2(-1, -1);
+            invalidateClutCache();
         } else if (command == 0x02) {
             // Fill rectangle
             cmd = Command::FillRectangle;
@@ -667,7 +946,11 @@ void GPU::writeGP0(uint32_t data) {
         } else if (command == 0x1f) {
             // Interrupt request
             irqRequest = true;
-            sys->interrupt->trigger(interrupt::IrqNumber::GPU);
+            if (commandThread) {
+                irqPending = true;
+            } else {
+                sys->interrupt->trigger(interrupt::IrqNumber::GPU);
+            }
         } else {
             fmt::print("GPU: GP0(0x{:02x}) args 0x{:06x}\n", command, arguments[0]);
         }
@@ -695,6 +978,10 @@ void GPU::writeGP0(uint32_t data) {
         }
     }
 
+    executeCommand();
+}
+
+void GPU::executeCommand() {
     if (gpuLogEnabled) {
         if (cmd == Command::CopyCpuToVram2) {
             // Find last gp0(0xa0) command
@@ -737,6 +1024,36 @@ void GPU::writeGP0(uint32_t data) {
     }
 }
 
+void GPU::submitPackets(const uint32_t* data, size_t words) {
+    Profiler::Scope scope(sys->profiler, Profiler::Section::gpu);
+    if (commandThread) {
+        trackSubmitted(data, words);
+        commandThread->push(data, words);
+    } else {
+        executePackets(data, words);
+    }
+}
+
+void GPU::executePackets(const uint32_t* data, size_t words) {
+    for (size_t i = 0; i < words;) {
+        bool header = cmd == Command::None;
+        writeGP0(data[i++]);
+        if (!header || cmd == Command::None) continue;
+
+        // Polyline length is known only after its terminator - it goes word by word
+        if (cmd == Command::Line && LineArgs(command).polyLine) continue;
+
+        // Packet continues in next chunk, remaining words are fed through writeGP0
+        size_t remaining = argumentCount - currentArgument;
+        if (i + remaining > words) continue;
+
+        std::copy_n(data + i, remaining, arguments.begin() + currentArgument);
+        currentArgument = argumentCount;
+        i += remaining;
+        executeCommand();
+    }
+}
+
 void GPU::writeGP1(uint32_t data) {
     uint8_t command = (data >> 24) & 0x3f;
     uint32_t argument = data & 0xffffff;
@@ -798,11 +1115,12 @@ void GPU::writeGP1(uint32_t data) {
 }
 
 bool GPU::emulateGpuCycles(int cycles) {
+    if (commandThread) raisePendingIrq();
     gpuDot += cycles;
 
-    int newLines = gpuDot / 3413;
+    int newLines = gpuDot / CYCLES_PER_LINE_NTSC;
     if (newLines == 0) return false;
-    gpuDot %= 3413;
+    gpuDot %= CYCLES_PER_LINE_NTSC;
     gpuLine += newLines;
 
     if (gpuLine < LINE_VBLANK_START_NTSC - 1) {
@@ -818,27 +1136,34 @@ bool GPU::emulateGpuCycles(int cycles) {
     if (gpuLine == LINES_TOTAL_NTSC - 1) {
         gpuLine = 0;
         frames++;
+
+        frameSkipped = frameSkip > 0 && frames % (frameSkip + 1) != 0;
+        if (!frameSkipped) flushDeferred();
         return true;
     }
     return false;
 }
 
-int GPU::minDrawingX(int x) const { return std::max((int)drawingArea.left, std::max(0, x)); }
-
-int GPU::minDrawingY(int y) const { return std::max((int)drawingArea.top, std::max(0, y)); }
-
-int GPU::maxDrawingX(int x) const { return std::min((int)drawingArea.right, std::min(VRAM_WIDTH, x)); }
-
-int GPU::maxDrawingY(int y) const { return std::min((int)drawingArea.bottom, std::min(VRAM_HEIGHT, y)); }
-
-bool GPU::insideDrawingArea(int x, int y) const {
-    return (x >= drawingArea.left) && (x < drawingArea.right) && (x < VRAM_WIDTH) && (y >= drawingArea.top) && (y < drawingArea.bottom)
-           && (y < VRAM_HEIGHT);
+bool GPU::isNtsc() const { return forceNtsc || gp1_08.videoMode == GP1_08::VideoMode::ntsc; }
+
+void GPU::captureFrame(Frame& frame) {
+    synchronize();
+    frame.vram = vram;
+    frame.vertices = vertices;
+    frame.gp1_08 = gp1_08;
+    frame.displayDisable = displayDisable;
+    frame.ntsc = isNtsc();
+    frame.displayAreaStartX = displayAreaStartX;
+    frame.displayAreaStartY = displayAreaStartY;
+    frame.displayRangeX1 = displayRangeX1;
+    frame.displayRangeX2 = displayRangeX2;
+    frame.displayRangeY1 = displayRangeY1;
+    frame.displayRangeY2 = displayRangeY2;
 }
 
-bool GPU::isNtsc() { return forceNtsc || gp1_08.videoMode == GP1_08::VideoMode::ntsc; }
-
 void GPU::dumpVram() {
+    flushDeferred();
+
     const char* dumpName = "vram.png";
     std::vector<uint8_t> vram(VRAM_WIDTH * VRAM_HEIGHT * 3);
 
@@ -1,5 +1,7 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "color_depth.h"
 #include "primitive.h"
@@ -14,16 +16,51 @@ class OpenGL;
 
 namespace gpu {
 
+class DrawQueue;
+class BandRenderer;
+class CommandThread;
+
 const int VRAM_WIDTH = 1024;
 const int VRAM_HEIGHT = 512;
 
 const int LINE_VBLANK_START_NTSC = 243;
 const int LINES_TOTAL_NTSC = 263;
+const int CYCLES_PER_LINE_NTSC = 3413;
+
+// VRAM and display state at the end of a frame, everything frontend needs to present it
+struct Frame {
+    std::array<uint16_t, VRAM_WIDTH * VRAM_HEIGHT> vram{};
+    std::vector<Vertex> vertices;
+
+    GP1_08 gp1_08;
+    bool displayDisable = false;
+    bool ntsc = true;
+    int16_t displayAreaStartX = 0;
+    int16_t displayAreaStartY = 0;
+    int16_t displayRangeX1 = 0;
+    int16_t displayRangeX2 = 0;
+    int16_t displayRangeY1 = 0;
+    int16_t displayRangeY2 = 0;
+
+    bool isNtsc() const { return ntsc; }
+};
+
+// Palette used for texture lookups is copied from VRAM and reused until CLUT position changes
+// or GP0(0x01) is received (VRAM writes in between are not visible)
+struct ClutCache {
+    std::array<uint16_t, 256> entries{};
+    uint16_t entriesPadding = 0;  // Rasterizer gathers read 32bit words, the last entry's upper half lands here
+    ivec2 pos{-1, -1};
+    ColorDepth colorDepth = ColorDepth::NONE;
+
+    void invalidate() { pos = ivec2(-1, -1); }
+};
 
 class GPU {
     friend struct ::System;
     friend class ::Render;
     friend class ::OpenGL;
+    friend class CommandThread;
 
     System* sys;
 
@@ -98,11 +135,10 @@ class GPU {
     bool textureDisableAllowed = false;
 
     std::array<uint16_t, VRAM_WIDTH * VRAM_HEIGHT> vram{};
+    uint16_t vramPadding = 0;  // Rasterizer gathers read 32bit words, the last pixel's upper half lands here
 
     // TODO: Serialize?
-    std::array<uint16_t, 256> clutCache{};
-    ivec2 clutCachePos{-1, -1};
-    ColorDepth clutCacheColorDepth = ColorDepth::NONE;
+    ClutCache clutCache;
 
    private:
     // Hardware rendering
@@ -112,6 +148,45 @@ class GPU {
     bool softwareRendering;
     bool hardwareRendering;
 
+    // Frame skip - only every (frameSkip + 1)th frame is presented,
+    // software rasterization is deferred until VRAM is observed
+    int frameSkip = 0;
+    bool frameSkipped = false;
+    std::unique_ptr<DrawQueue> drawQueue;
+
+    // Parallel software rendering - queued primitives are rasterized in horizontal bands on worker threads
+    std::unique_ptr<BandRenderer> bandRenderer;
+
+    bool isDeferring() const { return frameSkip > 0 || bandRenderer; }
+
+    // GP0 commands executed on separate thread. Display and timing state (GP1, GPUSTAT bits not set by GP0)
+    // stays on emulation thread, which accesses everything else only after synchronize().
+    std::unique_ptr<CommandThread> commandThread;
+    // GP0(0x1f) executed on GPU thread, interrupt is raised on emulation thread
+    std::atomic<bool> irqPending{false};
+
+    // GP0 state GPUSTAT depends on as of the last submitted word. Decoded on emulation thread while words are pushed
+    // to GPU thread, status reads don't have to wait until it catches up.
+    struct SubmittedState {
+        GP0_E1 gp0_e1;
+        GP0_E6 gp0_e6;
+        bool irqRequest = false;
+        Command cmd = Command::None;
+        bool polyLine = false;
+        int remaining = 0;      // Words left in packet (data words of CPU->VRAM transfer)
+        bool vramRead = false;  // VRAM->CPU transfer submitted, read mode is known only after it's executed
+
+        // Textured polygon copies its texture page to E1
+        int texpageRemaining = 0;  // Value of remaining when texture page word arrives, 0 - untextured
+        uint32_t texpage = 0;
+    };
+    SubmittedState submitted;
+
+    void raisePendingIrq();
+    // GPU thread has to be idle, words submitted later are decoded from current state
+    void syncSubmitted();
+    void trackSubmitted(const uint32_t* data, size_t words);
+
     void reset();
     void cmdFillRectangle();
     void cmdPolygon(PolygonArgs arg);
@@ -126,7 +201,15 @@ class GPU {
     void drawLine(const primitive::Line& line);
     void drawRectangle(const primitive::Rect& rect);
 
+    void invalidateClutCache();
+    void drawDeferred();
+    Rect<int> drawingBounds(int left, int top, int right, int bottom) const;
+    // Rasterizes queued primitives if operation reading and writing given VRAM areas depends on them
+    void settleDeferred(const Rect<int>& reads, const Rect<int>& writes);
+
     void writeGP0(uint32_t data);
+    void executeCommand();
+    void executePackets(const uint32_t* data, size_t words);
     void writeGP1(uint32_t data);
 
     void reload();
@@ -142,24 +225,37 @@ class GPU {
     bool emulateGpuCycles(int cycles);
     uint32_t read(uint32_t address);
     void write(uint32_t address, uint32_t data);
-    bool isNtsc();
-
-    int minDrawingX(int x) const;
-    int minDrawingY(int y) const;
-    int maxDrawingX(int x) const;
-    int maxDrawingY(int y) const;
-    bool insideDrawingArea(int x, int y) const;
+    // GP0 words in bulk (DMA) - complete packets skip per word command decoding
+    void submitPackets(const uint32_t* data, size_t words);
+    bool isNtsc() const;
+    // Copies state needed for presentation, frame can be then rendered on other thread
+    void captureFrame(Frame& frame);
+    // Last completed frame was skipped - its VRAM is not up to date and shouldn't be presented
+    bool isFrameSkipped() const { return frameSkipped; }
+    // Rasterizes all deferred primitives, VRAM is up to date afterwards
+    void flushDeferred();
+    void setFrameSkip(int frames);
+    // 0 - rasterize on emulation thread
+    void setRendererThreads(int threads);
+    void setCommandThread(bool enabled);
+    // Waits until GPU thread executes all submitted commands, VRAM and drawing state can be accessed afterwards
+    void synchronize();
 
     // Debug && replay
-    bool gpuLogEnabled = true;
+    bool gpuLogEnabled = false;  // Enabled by frontend while GPU log is shown, logged frames are always rasterized
     std::vector<LogEntry> gpuLogList;
     std::array<uint16_t, VRAM_WIDTH * VRAM_HEIGHT> prevVram{};
 
-    void clear() { vertices.clear(); }
+    void clear() {
+        if (hardwareRendering) synchronize();  // Vertices are produced by GPU thread
+        vertices.clear();
+    }
     void dumpVram();
 
     template <class Archive>
     void serialize(Archive& ar) {
+        flushDeferred();
+
         ar(startX, startY);
         ar(endX, endY);
         ar(currX, currY);
@@ -190,6 +286,7 @@ class GPU {
         ar(textureDisableAllowed);
 
         ar(vram);
+        syncSubmitted();
     }
 };
 
@@ -50,8 +50,12 @@ struct Triangle {
     ivec2 texpage;  // Texture page position in VRAM
     ivec2 clut;     // Texture palette position in VRAM
 
+    // Vertices were swapped by assureCcw (attribute rounding depends on submitted order)
+    bool reversed = false;
+
     void assureCcw() {
-        if (isCw()) {
+        reversed = isCw();
+        if (reversed) {
             std::swap(v[1], v[2]);
         }
     }
@@ -95,7 +95,7 @@ union GP1_08 {
 
     GP1_08() : _reg(0) {}
 
-    int getHorizontalResoulution() {
+    int getHorizontalResoulution() const {
         if (horizontalResolution2 == HorizontalResolution2::r386) return 368;
         if (horizontalResolution1 == HorizontalResolution::r256) return 256;
         if (horizontalResolution1 == HorizontalResolution::r320) return 320;
@@ -104,7 +104,7 @@ union GP1_08 {
         return 640;
     }
 
-    int getVerticalResoulution() {
+    int getVerticalResoulution() const {
         if (verticalResolution == VerticalResolution::r240) return 240;
         return 480;
     }
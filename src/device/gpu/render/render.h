@@ -1,9 +1,40 @@
 #pragma once
+#include <algorithm>
 #include "device/gpu/gpu.h"
 
 class Render {
    public:
-    static void drawLine(gpu::GPU* gpu, const primitive::Line& line);
-    static void drawTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle);
-    static void drawRectangle(gpu::GPU* gpu, const primitive::Rect& rect);
-};
\ No newline at end of file
+    // VRAM and state rasterizer draws with - GPU registers at the time primitive was submitted.
+    // Rows outside [top, bottom] are not touched (band rendering draws primitive in parts).
+    struct Target {
+        uint16_t* vram;  // Readable one halfword past the end (32bit gathers)
+        gpu::GP0_E1 gp0_e1;
+        gpu::GP0_E2 gp0_e2;
+        gpu::GP0_E6 gp0_e6;
+        gpu::Rect<int16_t> drawingArea;
+        gpu::ClutCache* clutCache;
+        int top = 0;
+        int bottom = gpu::VRAM_HEIGHT - 1;
+
+        int minDrawingX(int x) const { return std::max((int)drawingArea.left, std::max(0, x)); }
+        int minDrawingY(int y) const { return std::max((int)drawingArea.top, std::max(0, y)); }
+        int maxDrawingX(int x) const { return std::min((int)drawingArea.right, std::min(gpu::VRAM_WIDTH, x)); }
+        int maxDrawingY(int y) const { return std::min((int)drawingArea.bottom, std::min(gpu::VRAM_HEIGHT, y)); }
+        bool insideDrawingArea(int x, int y) const {
+            return (x >= drawingArea.left) && (x < drawingArea.right) && (x < gpu::VRAM_WIDTH) && (y >= drawingArea.top)
+                   && (y < drawingArea.bottom) && (y < gpu::VRAM_HEIGHT);
+        }
+        bool insideBand(int y) const { return y >= top && y <= bottom; }
+    };
+
+    // Current GPU state
+    static Target target(gpu::GPU* gpu);
+
+    static void drawLine(const Target& target, const primitive::Line& line);
+    static void drawTriangle(const Target& target, const primitive::Triangle& triangle);
+    static void drawRectangle(const Target& target, const primitive::Rect& rect);
+};
+
+inline Render::Target Render::target(gpu::GPU* gpu) {
+    return {gpu->vram.data(), gpu->gp0_e1, gpu->gp0_e2, gpu->gp0_e6, gpu->drawingArea, &gpu->clutCache};
+}
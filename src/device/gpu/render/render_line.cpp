@@ -4,13 +4,13 @@
 #include "utils/macros.h"
 
 #undef VRAM
-#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])gpu->vram.data())
+#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])target.vram)
 
-void Render::drawLine(gpu::GPU* gpu, const primitive::Line& line) {
-    const auto transparency = gpu->gp0_e1.semiTransparency;
-    const bool checkMaskBeforeDraw = gpu->gp0_e6.checkMaskBeforeDraw;
-    const bool setMaskWhileDrawing = gpu->gp0_e6.setMaskWhileDrawing;
-    const bool dithering = gpu->gp0_e1.dither24to15;
+void Render::drawLine(const Target& target, const primitive::Line& line) {
+    const auto transparency = target.gp0_e1.semiTransparency;
+    const bool checkMaskBeforeDraw = target.gp0_e6.checkMaskBeforeDraw;
+    const bool setMaskWhileDrawing = target.gp0_e6.setMaskWhileDrawing;
+    const bool dithering = target.gp0_e1.dither24to15;
 
     int x0 = line.pos[0].x;
     int y0 = line.pos[0].y;
@@ -58,6 +58,8 @@ void Render::drawLine(gpu::GPU* gpu, const primitive::Line& line) {
     };
 
     auto putPixel = [&](int x, int y, RGB fullColor) {
+        if (!target.insideBand(y)) return;
+
         PSXColor bg = VRAM[y][x];
         if (unlikely(checkMaskBeforeDraw)) {
             if (bg.k) return;
@@ -84,9 +86,9 @@ void Render::drawLine(gpu::GPU* gpu, const primitive::Line& line) {
     for (int _x = x0; _x <= x1; _x++) {
         if (steep) {
             // TODO: Remove insideDrawingArea calls
-            if (gpu->insideDrawingArea(_y, _x)) putPixel(_y, _x, getColor(_x, _y));
+            if (target.insideDrawingArea(_y, _x)) putPixel(_y, _x, getColor(_x, _y));
         } else {
-            if (gpu->insideDrawingArea(_x, _y)) putPixel(_x, _y, getColor(_x, _y));
+            if (target.insideDrawingArea(_x, _y)) putPixel(_x, _y, getColor(_x, _y));
         }
         error += derror;
         if (error > dx) {
@@ -4,14 +4,14 @@
 #include "utils/macros.h"
 
 #undef VRAM
-#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])gpu->vram.data())
+#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])target.vram)
 
 template <ColorDepth bits, bool isSemiTransparent, bool isBlended, bool checkMaskBeforeDraw>
-INLINE void rasterizeRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
+INLINE void rasterizeRectangle(const Render::Target& target, const primitive::Rect& rect) {
     // Extract common GPU state
-    const auto transparency = gpu->gp0_e1.semiTransparency;
-    const bool setMaskWhileDrawing = gpu->gp0_e6.setMaskWhileDrawing;
-    const auto textureWindow = gpu->gp0_e2;
+    const auto transparency = target.gp0_e1.semiTransparency;
+    const bool setMaskWhileDrawing = target.gp0_e6.setMaskWhileDrawing;
+    const auto textureWindow = target.gp0_e2;
     constexpr bool isTextured = bits != ColorDepth::NONE;
 
     if (rect.size.x >= 1024 || rect.size.y >= 512) return;
@@ -20,13 +20,13 @@ INLINE void rasterizeRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
         rect.pos.x,   //
         rect.pos.y    //
     );
-    const ivec2 min(              //
-        gpu->minDrawingX(pos.x),  //
-        gpu->minDrawingY(pos.y)   //
+    const ivec2 min(                //
+        target.minDrawingX(pos.x),  //
+        target.minDrawingY(pos.y)   //
     );
-    const ivec2 max(                                //
-        gpu->maxDrawingX(pos.x + rect.size.x - 1),  //
-        gpu->maxDrawingY(pos.y + rect.size.y - 1)   //
+    const ivec2 max(                                  //
+        target.maxDrawingX(pos.x + rect.size.x - 1),  //
+        target.maxDrawingY(pos.y + rect.size.y - 1)   //
     );
 
     const ivec2 uv(                   //
@@ -37,17 +37,21 @@ INLINE void rasterizeRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
 
     // Texture flipping
     // TODO: Not tested!
-    if (gpu->gp0_e1.texturedRectangleXFlip) {
+    if (target.gp0_e1.texturedRectangleXFlip) {
         uStep = -1;
     }
-    if (gpu->gp0_e1.texturedRectangleYFlip) {
+    if (target.gp0_e1.texturedRectangleYFlip) {
         vStep = -1;
     }
 
-    loadClutCacheIfRequired<bits>(gpu, rect.clut);
+    loadClutCacheIfRequired<bits>(target, rect.clut);
+
+    // Rows above the band are skipped
+    const int skip = std::max(0, target.top - min.y);
+    const int bottom = std::min(max.y, target.bottom);
 
     int x, y, u, v;
-    for (y = min.y, v = uv.y; y <= max.y; y++, v += vStep) {
+    for (y = min.y + skip, v = uv.y + skip * vStep; y <= bottom; y++, v += vStep) {
         for (x = min.x, u = uv.x; x <= max.x; x++, u += uStep) {
             PSXColor bg = VRAM[y][x];
             if constexpr (checkMaskBeforeDraw) {
@@ -59,7 +63,7 @@ INLINE void rasterizeRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
                 c = PSXColor(rect.color.r, rect.color.g, rect.color.b);
             } else {
                 const ivec2 texel = maskTexel(ivec2(u, v), textureWindow);
-                c = fetchTex<bits>(gpu, texel, rect.texpage);
+                c = fetchTex<bits>(target, texel, rect.texpage);
                 if (c.raw == 0x0000) continue;
 
                 if constexpr (isBlended) {
@@ -81,7 +85,7 @@ INLINE void rasterizeRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
 }
 
 // Generate all permutations of rasterizeRectangle
-using rasterizeRectangle_t = void(gpu::GPU* gpu, const primitive::Rect& rect);
+using rasterizeRectangle_t = void(const Render::Target& target, const primitive::Rect& rect);
 
 #define E(bits, isSemiTransparent, isBlended, checkMaskBit) \
     &rasterizeRectangle<bitsToDepth<bits>(), isSemiTransparent, isBlended, checkMaskBit>
@@ -110,13 +114,13 @@ static constexpr rasterizeRectangle_t* rasterizeRectangleDispatchTable[4][2][2][
       {{E(16, 1, 0, 0), E(16, 1, 0, 1)}, {E(16, 1, 1, 0), E(16, 1, 1, 1)}}}};
 #undef E
 
-void Render::drawRectangle(gpu::GPU* gpu, const primitive::Rect& rect) {
+void Render::drawRectangle(const Target& target, const primitive::Rect& rect) {
     auto bits = (int)bitsToDepth(rect.bits);
     auto isSemiTransparent = rect.isSemiTransparent;
     auto isBlended = !rect.isRawTexture;
-    auto checkMaskBit = gpu->gp0_e6.checkMaskBeforeDraw;
+    auto checkMaskBit = target.gp0_e6.checkMaskBeforeDraw;
 
     auto rasterize = rasterizeRectangleDispatchTable[bits][isSemiTransparent][isBlended][checkMaskBit];
 
-    rasterize(gpu, rect);
+    rasterize(target, rect);
 }
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "dither.h"
 #include "texture_utils.h"
 #include "utils/macros.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #undef VRAM
-#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])gpu->vram.data())
+#define VRAM ((uint16_t(*)[gpu::VRAM_WIDTH])target.vram)
 
 int orient2d(const ivec2& a, const ivec2& b, const ivec2& c) {  //
     return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
@@ -26,23 +29,16 @@ void calculateFillRuleBias(int bias[3], const ivec2 pos[3]) {
     bias[2] = isTopLeft(D01) ? -1 : 0;
 }
 
-// TODO: Fixed point has some rounding issue, need more investigation
-// #define USE_FIXED_POINT
-
 #ifdef USE_FIXED_POINT
-#define FP_PRECISION 12
-#define FP_PADDING 12
-
-using delta_t = int32_t;
-#define TO_FP(x) ((x) * (1 << FP_PRECISION))
-#define FROM_FP(x) ((x) >> (FP_PRECISION + FP_PADDING))
-#define ADD_PADDING(x) ((delta_t)(x) << FP_PADDING)
+// Attributes are unsigned 8.24 fixed point numbers, integer part wraps around.
+// Setup follows rounding rules researched by Mednafen: gradients are computed from rounded
+// reciprocal of the area and rounded up, start values are taken from the leftmost vertex.
+// Stepping is exact - attribute at any pixel doesn't depend on the path taken to it.
+using delta_t = uint32_t;
+#define FROM_FP(x) ((x) >> 24)
 #else
-
 using delta_t = float;
-#define TO_FP(x) (x)
 #define FROM_FP(x) (x)
-#define ADD_PADDING(x) (x)
 #endif
 
 struct Attributes {
@@ -63,17 +59,40 @@ struct AttributeDeltas {
  * p - vertex position
  * a - attribute values per vertex
  */
-delta_t calculateXDelta(const ivec2 p[3], const int a[3]) {
+int calculateXDelta(const ivec2 p[3], const int a[3]) {
     return (p[1].y - p[2].y) * a[0] + (p[2].y - p[0].y) * a[1] + (p[0].y - p[1].y) * a[2];
 }
 
-delta_t calculateYDelta(const ivec2 p[3], const int a[3]) {
+int calculateYDelta(const ivec2 p[3], const int a[3]) {
     return (p[2].x - p[1].x) * a[0] + (p[0].x - p[2].x) * a[1] + (p[1].x - p[0].x) * a[2];
 }
 
+#ifdef USE_FIXED_POINT
+// 1/area with 44 fractional bits
+int64_t calculateReciprocal(const int area) { return (int64_t(1) << 44) / area; }
+
+AttributeDeltas::Delta calculateDelta(const int64_t reciprocal, const ivec2 p[3], const int a[3]) {
+    const auto gradient = [reciprocal](int64_t d) { return (delta_t)((reciprocal * d + 0xffffffff) >> 32) << 12; };
+    return {gradient(calculateXDelta(p, a)), gradient(calculateYDelta(p, a))};
+}
+
+// Leftmost vertex, the latter one (in submitted order) is picked when two of them share x
+int calculateCoreVertex(const primitive::Triangle& triangle) {
+    const int order[3] = {0, triangle.reversed ? 2 : 1, triangle.reversed ? 1 : 2};
+    const int x[3] = {triangle.v[order[0]].pos.x, triangle.v[order[1]].pos.x, triangle.v[order[2]].pos.x};
+
+    if (x[1] <= x[0]) return order[x[2] <= x[1] ? 2 : 1];
+    return order[x[2] < x[0] ? 2 : 0];
+}
+
+// Value at (0, 0) - rounded value at the core vertex moved back by gradients
+delta_t calculateStartAttribute(const ivec2 core, const int a, const AttributeDeltas::Delta& delta) {
+    return ((delta_t)a << 24) + (1 << 23) - delta.x * core.x - delta.y * core.y;
+}
+#else
 AttributeDeltas::Delta calculateDelta(const int area, const ivec2 p[3], const int a[3]) {
-    delta_t x = ADD_PADDING(TO_FP(calculateXDelta(p, a)) / area);
-    delta_t y = ADD_PADDING(TO_FP(calculateYDelta(p, a)) / area);
+    delta_t x = static_cast<float>(calculateXDelta(p, a)) / area;
+    delta_t y = static_cast<float>(calculateYDelta(p, a)) / area;
 
     return {x, y};
 }
@@ -83,73 +102,91 @@ delta_t calculateStartAttribute(const int area, const ivec2 p[3], const int bias
     float B = (p[2].x * p[0].y - p[0].x * p[2].y) * a[1] - bias[1];
     float C = (p[0].x * p[1].y - p[1].x * p[0].y) * a[2] - bias[2];
 
-#ifdef USE_FIXED_POINT
-    auto half = (1 << (FP_PRECISION - 1));
-#else
-    auto half = 0.5f;
-#endif
-    return ADD_PADDING((TO_FP(A + B + C) / static_cast<float>(area)) + half);
+    return ((A + B + C) / static_cast<float>(area)) + 0.5f;
 }
+#endif
 
 template <bool isGouraudShaded, bool isTextured>
-Attributes calculateStartAttributes(const primitive::Triangle& triangle) {
+AttributeDeltas calculateDeltas(const primitive::Triangle& triangle) {
     ivec2 p[3] = {triangle.v[0].pos, triangle.v[1].pos, triangle.v[2].pos};
 
     const int area = orient2d(p[0], p[1], p[2]);
     if (area == 0) return {};
 
-    int bias[3];
-    calculateFillRuleBias(bias, p);
+#ifdef USE_FIXED_POINT
+    const int64_t scale = calculateReciprocal(area);
+#else
+    const int scale = area;
+#endif
 
-    Attributes attrs = {};
+    AttributeDeltas deltas = {};
     if constexpr (isGouraudShaded) {
         int r[3] = {triangle.v[0].color.r, triangle.v[1].color.r, triangle.v[2].color.r};
         int g[3] = {triangle.v[0].color.g, triangle.v[1].color.g, triangle.v[2].color.g};
         int b[3] = {triangle.v[0].color.b, triangle.v[1].color.b, triangle.v[2].color.b};
 
-        attrs.r = calculateStartAttribute(area, p, bias, r);
-        attrs.g = calculateStartAttribute(area, p, bias, g);
-        attrs.b = calculateStartAttribute(area, p, bias, b);
+        deltas.r = calculateDelta(scale, p, r);
+        deltas.g = calculateDelta(scale, p, g);
+        deltas.b = calculateDelta(scale, p, b);
     }
 
     if constexpr (isTextured) {
         int u[3] = {triangle.v[0].uv.x, triangle.v[1].uv.x, triangle.v[2].uv.x};
         int v[3] = {triangle.v[0].uv.y, triangle.v[1].uv.y, triangle.v[2].uv.y};
 
-        attrs.u = calculateStartAttribute(area, p, bias, u);
-        attrs.v = calculateStartAttribute(area, p, bias, v);
+        deltas.u = calculateDelta(scale, p, u);
+        deltas.v = calculateDelta(scale, p, v);
     }
 
-    return attrs;
+    return deltas;
 }
 
 template <bool isGouraudShaded, bool isTextured>
-AttributeDeltas calculateDeltas(const primitive::Triangle& triangle) {
+Attributes calculateStartAttributes(const primitive::Triangle& triangle, const AttributeDeltas& deltas) {
     ivec2 p[3] = {triangle.v[0].pos, triangle.v[1].pos, triangle.v[2].pos};
 
     const int area = orient2d(p[0], p[1], p[2]);
     if (area == 0) return {};
 
-    AttributeDeltas deltas = {};
+    Attributes attrs = {};
+#ifdef USE_FIXED_POINT
+    const auto& core = triangle.v[calculateCoreVertex(triangle)];
+    if constexpr (isGouraudShaded) {
+        attrs.r = calculateStartAttribute(core.pos, core.color.r, deltas.r);
+        attrs.g = calculateStartAttribute(core.pos, core.color.g, deltas.g);
+        attrs.b = calculateStartAttribute(core.pos, core.color.b, deltas.b);
+    }
+
+    if constexpr (isTextured) {
+        attrs.u = calculateStartAttribute(core.pos, core.uv.x, deltas.u);
+        attrs.v = calculateStartAttribute(core.pos, core.uv.y, deltas.v);
+    }
+#else
+    (void)deltas;
+
+    int bias[3];
+    calculateFillRuleBias(bias, p);
+
     if constexpr (isGouraudShaded) {
         int r[3] = {triangle.v[0].color.r, triangle.v[1].color.r, triangle.v[2].color.r};
         int g[3] = {triangle.v[0].color.g, triangle.v[1].color.g, triangle.v[2].color.g};
         int b[3] = {triangle.v[0].color.b, triangle.v[1].color.b, triangle.v[2].color.b};
 
-        deltas.r = calculateDelta(area, p, r);
-        deltas.g = calculateDelta(area, p, g);
-        deltas.b = calculateDelta(area, p, b);
+        attrs.r = calculateStartAttribute(area, p, bias, r);
+        attrs.g = calculateStartAttribute(area, p, bias, g);
+        attrs.b = calculateStartAttribute(area, p, bias, b);
     }
 
     if constexpr (isTextured) {
         int u[3] = {triangle.v[0].uv.x, triangle.v[1].uv.x, triangle.v[2].uv.x};
         int v[3] = {triangle.v[0].uv.y, triangle.v[1].uv.y, triangle.v[2].uv.y};
 
-        deltas.u = calculateDelta(area, p, u);
-        deltas.v = calculateDelta(area, p, v);
+        attrs.u = calculateStartAttribute(area, p, bias, u);
+        attrs.v = calculateStartAttribute(area, p, bias, v);
     }
+#endif
 
-    return deltas;
+    return attrs;
 }
 
 template <bool isGouraudShaded, bool isTextured>
@@ -185,12 +222,255 @@ RGB dither(const RGB color, const ivec2 p) {
     return RGB(r, g, b);
 }
 
+#ifdef __AVX2__
+#define RASTERIZE_AVX2
+
+// AVX2 path - 8 horizontally adjacent pixels per iteration, one 32bit lane per pixel.
+// Every step reproduces the scalar loop exactly, output is bit identical.
+namespace simd {
+INLINE __m256i set(int v) { return _mm256_set1_epi32(v); }
+INLINE __m256i lanes() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+
+// Edge function increments for pixels of the group
+INLINE __m256i steps(int delta) { return _mm256_mullo_epi32(lanes(), set(delta)); }
+
+#ifdef USE_FIXED_POINT
+// Integer part of attribute for 8 consecutive pixels, attrib is advanced past the group
+INLINE __m256i interpolate(delta_t& attrib, const delta_t delta) {
+    const __m256i v = _mm256_add_epi32(set(attrib), _mm256_mullo_epi32(lanes(), set(delta)));
+    attrib += delta * 8;
+    return _mm256_srli_epi32(v, 24);
+}
+#else
+// Attribute for 8 consecutive pixels. Lane k gets k additions of delta - the same float operations
+// in the same order as scalar loop does, attrib is advanced past the group.
+INLINE __m256 interpolate(delta_t& attrib, const delta_t delta) {
+    const __m256 d = _mm256_set1_ps(delta);
+    __m256 v = _mm256_set1_ps(attrib);
+    for (int k = 1; k < 8; k++) {
+        const __m256 active = _mm256_castsi256_ps(_mm256_cmpgt_epi32(lanes(), set(k - 1)));
+        v = _mm256_add_ps(v, _mm256_and_ps(d, active));
+    }
+    attrib = _mm_cvtss_f32(_mm_permute_ps(_mm256_extractf128_ps(v, 1), 0xff)) + delta;
+    return v;
+}
+#endif
+
+// float -> int -> uint8_t conversion done by RGB constructor
+INLINE __m256i toColor(const __m256 v) { return _mm256_and_si256(_mm256_cvttps_epi32(v), set(0xff)); }
+INLINE __m256i toColor(const __m256i v) { return v; }
+
+INLINE __m256i toCoordinate(const __m256 v) { return _mm256_cvttps_epi32(v); }
+INLINE __m256i toCoordinate(const __m256i v) { return v; }
+
+template <int shift>
+INLINE __m256i channel(const __m256i c) {
+    return _mm256_and_si256(_mm256_srli_epi32(c, shift), set(31));
+}
+
+INLINE __m256i toPSXColor(const __m256i r, const __m256i g, const __m256i b) {
+    const __m256i rg = _mm256_or_si256(_mm256_srli_epi32(r, 3), _mm256_slli_epi32(_mm256_srli_epi32(g, 3), 5));
+    return _mm256_or_si256(rg, _mm256_slli_epi32(_mm256_srli_epi32(b, 3), 10));
+}
+
+// ditherLUT lookup, offset selects x & 3 row (4096 bytes each), 4 byte reads of entries < 256 stay inside it
+INLINE __m256i dither(const uint8_t* row, const __m256i offset, const __m256i c) {
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)row, _mm256_add_epi32(offset, c), 1), set(0xff));
+}
+
+// Gathers read 32bits, upper halfword belongs to next pixel (GPU::vram and ClutCache::entries are followed by padding)
+INLINE __m256i gather16(const uint16_t* base, const __m256i index) {
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)base, index, 2), set(0xffff));
+}
+
+template <ColorDepth bits>
+INLINE __m256i fetchTex(const Render::Target& target, const __m256i u, const __m256i v, const ivec2 texPage) {
+    const __m256i row = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(set(texPage.y), v), set(511)), 10);
+    if constexpr (bits == ColorDepth::BIT_4) {
+        const __m256i column = _mm256_and_si256(_mm256_add_epi32(set(texPage.x), _mm256_srli_epi32(u, 2)), set(1023));
+        const __m256i index = gather16(target.vram, _mm256_add_epi32(row, column));
+        const __m256i entry = _mm256_and_si256(_mm256_srlv_epi32(index, _mm256_slli_epi32(_mm256_and_si256(u, set(3)), 2)), set(0xf));
+        return gather16(target.clutCache->entries.data(), entry);
+    } else if constexpr (bits == ColorDepth::BIT_8) {
+        const __m256i column = _mm256_and_si256(_mm256_add_epi32(set(texPage.x), _mm256_srli_epi32(u, 1)), set(1023));
+        const __m256i index = gather16(target.vram, _mm256_add_epi32(row, column));
+        const __m256i entry = _mm256_and_si256(_mm256_srlv_epi32(index, _mm256_slli_epi32(_mm256_and_si256(u, set(1)), 3)), set(0xff));
+        return gather16(target.clutCache->entries.data(), entry);
+    } else {
+        const __m256i column = _mm256_and_si256(_mm256_add_epi32(set(texPage.x), u), set(1023));
+        return gather16(target.vram, _mm256_add_epi32(row, column));
+    }
+}
+
+// PSXColor * RGB
+template <int shift>
+INLINE __m256i modulateChannel(const __m256i c, const __m256i rhs) {
+    return _mm256_slli_epi32(_mm256_min_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(channel<shift>(c), rhs), 7), set(31)), shift);
+}
+
+INLINE __m256i modulate(const __m256i c, const __m256i r, const __m256i g, const __m256i b) {
+    return _mm256_or_si256(_mm256_or_si256(modulateChannel<0>(c, r), modulateChannel<5>(c, g)),
+                           _mm256_or_si256(modulateChannel<10>(c, b), _mm256_and_si256(c, set(0x8000))));
+}
+
+// PSXColor::blend
+template <int shift>
+INLINE __m256i blendChannel(const __m256i bg, const __m256i c, const gpu::SemiTransparency transparency) {
+    const __m256i b = channel<shift>(bg);
+    const __m256i f = channel<shift>(c);
+    __m256i result;
+    switch (transparency) {
+        case gpu::SemiTransparency::Bby2plusFby2: result = _mm256_srli_epi32(_mm256_add_epi32(b, f), 1); break;
+        case gpu::SemiTransparency::BplusF: result = _mm256_min_epi32(_mm256_add_epi32(b, f), set(31)); break;
+        case gpu::SemiTransparency::BminusF: result = _mm256_max_epi32(_mm256_sub_epi32(b, f), set(0)); break;
+        case gpu::SemiTransparency::BplusFby4: result = _mm256_min_epi32(_mm256_add_epi32(b, _mm256_srli_epi32(f, 2)), set(31)); break;
+        default: result = set(0); break;
+    }
+    return _mm256_slli_epi32(result, shift);
+}
+
+INLINE __m256i blend(const __m256i bg, const __m256i c, const gpu::SemiTransparency transparency) {
+    return _mm256_or_si256(_mm256_or_si256(blendChannel<0>(bg, c, transparency), blendChannel<5>(bg, c, transparency)),
+                           _mm256_or_si256(blendChannel<10>(bg, c, transparency), _mm256_and_si256(c, set(0x8000))));
+}
+
+// Texels fetched for whole group before any of its pixels is written - triangles sampling area
+// they draw to are left for scalar loop (pixel order matters there).
+template <ColorDepth bits>
+bool samplesDestination(const ivec2 texPage, const ivec2 min, const ivec2 max) {
+    if constexpr (bits == ColorDepth::NONE) {
+        return false;
+    } else {
+        constexpr int width = bits == ColorDepth::BIT_4 ? 64 : bits == ColorDepth::BIT_8 ? 128 : 256;
+        // Wrapping range [start, start+size) against [from, to]
+        auto overlaps = [](int start, int size, int wrap, int from, int to) {
+            return ((from - start) & (wrap - 1)) < size || ((start - from) & (wrap - 1)) <= to - from;
+        };
+        return overlaps(texPage.x, width, gpu::VRAM_WIDTH, min.x, max.x) && overlaps(texPage.y, 256, gpu::VRAM_HEIGHT, min.y, max.y);
+    }
+}
+
+struct Constants {
+    __m256i edgeStep[3];
+    __m256i windowAndU, windowOrU;
+    __m256i windowAndV, windowOrV;
+    __m256i colorFlat;  // As PSXColor
+    __m256i flatR, flatG, flatB;
+    __m256i maskBit;
+};
+
 template <ColorDepth bits, bool isSemiTransparent, bool isGouraudShaded, bool isBlended, bool checkMaskBeforeDraw, bool dithering>
-void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
+INLINE void shade(const Render::Target& target, const primitive::Triangle& triangle, const Constants& k, const ivec2 p, const int CX[3], Attributes& attrib,
+                  const AttributeDeltas& deltas) {
+    constexpr bool isTextured = bits != ColorDepth::NONE;
+    constexpr bool isDithered = dithering && isBlended;
+
+    __m256i r, g, b;
+    if constexpr (isGouraudShaded) {
+        r = toColor(interpolate(attrib.r, deltas.r.x));
+        g = toColor(interpolate(attrib.g, deltas.g.x));
+        b = toColor(interpolate(attrib.b, deltas.b.x));
+    }
+    __m256i u, v;
+    if constexpr (isTextured) {
+        u = toCoordinate(interpolate(attrib.u, deltas.u.x));
+        v = toCoordinate(interpolate(attrib.v, deltas.v.x));
+    }
+
+    // (CX[0] | CX[1] | CX[2]) > 0
+    const __m256i e0 = _mm256_add_epi32(set(CX[0]), k.edgeStep[0]);
+    const __m256i e1 = _mm256_add_epi32(set(CX[1]), k.edgeStep[1]);
+    const __m256i e2 = _mm256_add_epi32(set(CX[2]), k.edgeStep[2]);
+    __m256i write = _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(e0, e1), e2), set(0));
+    if (_mm256_testz_si256(write, write)) return;
+
+    uint16_t* dst = &VRAM[p.y][p.x];
+    const __m256i bg = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)dst));
+    if constexpr (checkMaskBeforeDraw) {
+        write = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(bg, set(0x8000)), set(0x8000)), write);
+    }
+
+    if constexpr (isDithered && isGouraudShaded) {
+        const uint8_t* row = ditherLUT[p.y & 3u][0].data();
+        const __m256i offset = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(set(p.x), lanes()), set(3)), 12);
+        r = dither(row, offset, r);
+        g = dither(row, offset, g);
+        b = dither(row, offset, b);
+    }
+
+    __m256i c;
+    if constexpr (bits == ColorDepth::NONE) {
+        if constexpr (!isGouraudShaded) {
+            c = k.colorFlat;
+        } else {
+            c = toPSXColor(r, g, b);
+        }
+    } else {
+        u = _mm256_or_si256(_mm256_and_si256(_mm256_and_si256(u, set(0xff)), k.windowAndU), k.windowOrU);
+        v = _mm256_or_si256(_mm256_and_si256(_mm256_and_si256(v, set(0xff)), k.windowAndV), k.windowOrV);
+        c = fetchTex<bits>(target, u, v, triangle.texpage);
+        write = _mm256_andnot_si256(_mm256_cmpeq_epi32(c, set(0)), write);
+
+        if constexpr (isBlended) {
+            if constexpr (isGouraudShaded) {
+                c = modulate(c, r, g, b);
+            } else {
+                c = modulate(c, k.flatR, k.flatG, k.flatB);
+            }
+        }
+    }
+
+    if constexpr (isSemiTransparent) {
+        const __m256i blended = blend(bg, c, triangle.transparency);
+        if constexpr (!isTextured) {
+            c = blended;
+        } else {
+            c = _mm256_blendv_epi8(c, blended, _mm256_cmpeq_epi32(_mm256_and_si256(c, set(0x8000)), set(0x8000)));
+        }
+    }
+
+    c = _mm256_or_si256(c, k.maskBit);
+
+    const __m256i result = _mm256_blendv_epi8(bg, c, write);
+    _mm_storeu_si128((__m128i*)dst, _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+}
+};  // namespace simd
+#endif
+
+#ifdef USE_FIXED_POINT
+// Bounding box is split into TILE_SIZE x TILE_SIZE tiles, rows skip tiles lying entirely outside of the triangle
+constexpr int TILE_SIZE = 8;
+
+/**
+ * Pixel range [from, to] of tiles in the strip that may be covered (from > to if there are none).
+ * C - edge values at (minX, top row of the strip), stepX/stepY - their increments per pixel
+ * Edge functions are linear - tile is outside when any of them is negative in all of its corners.
+ * Such tiles can only be at both ends of the strip, the rest forms a single range.
+ */
+void calculateStripRange(int& from, int& to, const int C[3], const int stepX[3], const int stepY[3], const int minX, const int maxX,
+                         const int height) {
+    from = minX;
+    to = minX - 1;
+    for (int x0 = minX; x0 <= maxX; x0 += TILE_SIZE) {
+        const int x1 = std::min(x0 + TILE_SIZE - 1, maxX);
+        bool outside = false;
+        for (int e = 0; e < 3; e++) {
+            const int corner = C[e] + stepX[e] * (x0 - minX) + std::max(stepX[e] * (x1 - x0), 0) + std::max(stepY[e] * (height - 1), 0);
+            outside |= corner < 0;
+        }
+        if (outside) continue;
+        if (from > to) from = x0;
+        to = x1;
+    }
+}
+#endif
+
+template <ColorDepth bits, bool isSemiTransparent, bool isGouraudShaded, bool isBlended, bool checkMaskBeforeDraw, bool dithering>
+void rasterizeTriangle(const Render::Target& target, const primitive::Triangle& triangle) {
     // Extract common GPU state
     const auto transparency = triangle.transparency;
-    const bool setMaskWhileDrawing = gpu->gp0_e6.setMaskWhileDrawing;
-    const auto textureWindow = gpu->gp0_e2;
+    const bool setMaskWhileDrawing = target.gp0_e6.setMaskWhileDrawing;
+    const auto textureWindow = target.gp0_e2;
     constexpr bool isTextured = bits != ColorDepth::NONE;
     constexpr bool isDithered = dithering && isBlended;
 
@@ -200,7 +480,7 @@ void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
     const int area = orient2d(pos[0], pos[1], pos[2]);
     if (area == 0) return;
 
-    loadClutCacheIfRequired<bits>(gpu, triangle.clut);
+    loadClutCacheIfRequired<bits>(target, triangle.clut);
 
     ivec2 min(                                     //
         std::min({pos[0].x, pos[1].x, pos[2].x}),  //
@@ -216,12 +496,12 @@ void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
     if (size.x >= 1024 || size.y >= 512) return;
 
     min = ivec2(                  //
-        gpu->minDrawingX(min.x),  //
-        gpu->minDrawingY(min.y)   //
+        target.minDrawingX(min.x),  //
+        target.minDrawingY(min.y)   //
     );
     max = ivec2(                  //
-        gpu->maxDrawingX(max.x),  //
-        gpu->maxDrawingY(max.y)   //
+        target.maxDrawingX(max.x),  //
+        target.maxDrawingY(max.y)   //
     );
 
     // https://fgiesen.wordpress.com/2013/02/10/optimizing-the-basic-rasterizer/
@@ -242,18 +522,74 @@ void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
         orient2d(pos[0], pos[1], min) + bias[2]   //
     };
 
-    Attributes startAttributes = calculateStartAttributes<isGouraudShaded, isTextured>(triangle);
     AttributeDeltas deltas = calculateDeltas<isGouraudShaded, isTextured>(triangle);
+    Attributes startAttributes = calculateStartAttributes<isGouraudShaded, isTextured>(triangle, deltas);
 
     addYDeltas<isGouraudShaded, isTextured>(startAttributes, deltas, min.y);
     addXDeltas<isGouraudShaded, isTextured>(startAttributes, deltas, min.x);
 
+    // Rows above the band are only stepped over - attributes accumulate row by row
+    for (; min.y < target.top && min.y <= max.y; min.y++) {
+        CY[0] += D12.x;
+        CY[1] += D20.x;
+        CY[2] += D01.x;
+        addYDeltas<isGouraudShaded, isTextured>(startAttributes, deltas);
+    }
+    max.y = std::min(max.y, target.bottom);
+
+#ifdef RASTERIZE_AVX2
+    const bool vectorize = !simd::samplesDestination<bits>(triangle.texpage, min, max);
+    simd::Constants constants;
+    constants.edgeStep[0] = simd::steps(D12.y);
+    constants.edgeStep[1] = simd::steps(D20.y);
+    constants.edgeStep[2] = simd::steps(D01.y);
+    constants.windowAndU = simd::set(~(textureWindow.maskX * 8));
+    constants.windowOrU = simd::set((textureWindow.offsetX & textureWindow.maskX) * 8);
+    constants.windowAndV = simd::set(~(textureWindow.maskY * 8));
+    constants.windowOrV = simd::set((textureWindow.offsetY & textureWindow.maskY) * 8);
+    constants.colorFlat = simd::set(PSXColor(colorFlat).raw);
+    constants.flatR = simd::set(colorFlat.r);
+    constants.flatG = simd::set(colorFlat.g);
+    constants.flatB = simd::set(colorFlat.b);
+    constants.maskBit = simd::set(setMaskWhileDrawing ? 0x8000 : 0);
+#endif
+
+#ifdef USE_FIXED_POINT
+    // Attributes are exact at any pixel - rows can start anywhere. Narrow triangles are cheaper to draw whole.
+    const bool tiled = max.x - min.x >= 2 * TILE_SIZE;
+    const int stepX[3] = {D12.y, D20.y, D01.y};
+    const int stepY[3] = {D12.x, D20.x, D01.x};
+    int from = min.x, to = max.x;
+#else
+    const int from = min.x, to = max.x;
+#endif
+
     ivec2 p;
     for (p.y = min.y; p.y <= max.y; p.y++) {
         Attributes attrib = startAttributes;
         int CX[3] = {CY[0], CY[1], CY[2]};
 
-        for (p.x = min.x; p.x <= max.x; p.x++) {
+#ifdef USE_FIXED_POINT
+        if (tiled) {
+            if ((p.y - min.y) % TILE_SIZE == 0) {
+                calculateStripRange(from, to, CY, stepX, stepY, min.x, max.x, std::min(TILE_SIZE, max.y - p.y + 1));
+            }
+            for (int e = 0; e < 3; e++) CX[e] += stepX[e] * (from - min.x);
+            addXDeltas<isGouraudShaded, isTextured>(attrib, deltas, from - min.x);
+        }
+#endif
+
+        p.x = from;
+#ifdef RASTERIZE_AVX2
+        for (; vectorize && p.x + 7 <= to; p.x += 8) {
+            simd::shade<bits, isSemiTransparent, isGouraudShaded, isBlended, checkMaskBeforeDraw, dithering>(target, triangle, constants, p, CX,
+                                                                                                             attrib, deltas);
+            CX[0] += D12.y * 8;
+            CX[1] += D20.y * 8;
+            CX[2] += D01.y * 8;
+        }
+#endif
+        for (; p.x <= to; p.x++) {
             if ((CX[0] | CX[1] | CX[2]) > 0) {
                 const PSXColor bg = VRAM[p.y][p.x];
                 if constexpr (checkMaskBeforeDraw) {
@@ -280,7 +616,7 @@ void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
                 } else {
                     const ivec2 uv(FROM_FP(attrib.u), FROM_FP(attrib.v));
                     const ivec2 texel = maskTexel(uv, textureWindow);
-                    c = fetchTex<bits>(gpu, texel, triangle.texpage);
+                    c = fetchTex<bits>(target, texel, triangle.texpage);
                     if (c.raw == 0x0000) goto DONE;
 
                     if constexpr (isBlended) {
@@ -321,7 +657,7 @@ void rasterizeTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
 }
 
 // Generate all permutations of rasterizeTriangle so that compiler can provide optimized versions of the function (no ifs in loop)
-using rasterizeTriangle_t = void(gpu::GPU* gpu, const primitive::Triangle& triangle);
+using rasterizeTriangle_t = void(const Render::Target& target, const primitive::Triangle& triangle);
 
 #define E(bits, isSemiTransparent, isGouraudShaded, isBlended, checkMaskBit, dithering) \
     &rasterizeTriangle<bitsToDepth<bits>(), isSemiTransparent, isGouraudShaded, isBlended, checkMaskBit, dithering>
@@ -379,15 +715,15 @@ static constexpr rasterizeTriangle_t* rasterizeTriangleDispatchTable[4][2][2][2]
         {{E(16, 1, 1, 1, 0, 0), E(16, 1, 1, 1, 0, 1)}, {E(16, 1, 1, 1, 1, 0), E(16, 1, 1, 1, 1, 1)}}}}}};
 #undef E
 
-void Render::drawTriangle(gpu::GPU* gpu, const primitive::Triangle& triangle) {
+void Render::drawTriangle(const Target& target, const primitive::Triangle& triangle) {
     auto bits = (int)bitsToDepth(triangle.bits);
     auto isSemiTransparent = triangle.isSemiTransparent;
     auto isGouraudShaded = triangle.gouraudShading;
     auto isBlended = !triangle.isRawTexture;
-    auto checkMaskBit = gpu->gp0_e6.checkMaskBeforeDraw;
-    auto dithering = gpu->gp0_e1.dither24to15;
+    auto checkMaskBit = target.gp0_e6.checkMaskBeforeDraw;
+    auto dithering = target.gp0_e1.dither24to15;
 
     auto rasterize = rasterizeTriangleDispatchTable[bits][isSemiTransparent][isGouraudShaded][isBlended][checkMaskBit][dithering];
 
-    rasterize(gpu, triangle);
+    rasterize(target, triangle);
 }
\ No newline at end of file
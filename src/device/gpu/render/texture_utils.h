@@ -1,57 +1,61 @@
 #pragma once
 #include "device/gpu/gpu.h"
+#include "render.h"
 #include "utils/macros.h"
 #include "../color_depth.h"
 #include "../primitive.h"
 
-#define gpuVRAM ((uint16_t(*)[gpu::VRAM_WIDTH])gpu->vram.data())
+#define gpuVRAM ((uint16_t(*)[gpu::VRAM_WIDTH])target.vram)
 
 template <ColorDepth bits>
-void loadClutCacheIfRequired(gpu::GPU* gpu, ivec2 clut) {
+void loadClutCacheIfRequired(const Render::Target& target, ivec2 clut) {
     // Only paletted textures should reload the color look-up table cache
     if constexpr (bits != ColorDepth::BIT_4 && bits != ColorDepth::BIT_8) {
         return;
     }
 
-    bool textureFormatRequireReload = bits > gpu->clutCacheColorDepth;
-    bool clutPositionChanged = gpu->clutCachePos != clut;
+    auto& cache = *target.clutCache;
+    bool textureFormatRequireReload = bits > cache.colorDepth;
+    bool clutPositionChanged = cache.pos != clut;
 
     if (!textureFormatRequireReload && !clutPositionChanged) {
         return;
     }
 
-    gpu->clutCacheColorDepth = bits;
-    gpu->clutCachePos = clut;
+    cache.colorDepth = bits;
+    cache.pos = clut;
 
     constexpr int entries = (bits == ColorDepth::BIT_8) ? 256 : 16;
     for (int i = 0; i < entries; i++) {
-        gpu->clutCache[i] = gpuVRAM[clut.y][clut.x + i];
+        cache.entries[i] = gpuVRAM[clut.y][clut.x + i];
     }
 }
 
 namespace {
-INLINE uint16_t tex4bit(gpu::GPU* gpu, ivec2 tex, ivec2 texPage) {
+INLINE uint16_t tex4bit(const Render::Target& target, ivec2 tex, ivec2 texPage) {
     uint16_t index = gpuVRAM[(texPage.y + tex.y) & 511][(texPage.x + tex.x / 4) & 1023];
     uint8_t entry = (index >> ((tex.x & 3) * 4)) & 0xf;
-    return gpu->clutCache[entry];
+    return target.clutCache->entries[entry];
 }
 
-INLINE uint16_t tex8bit(gpu::GPU* gpu, ivec2 tex, ivec2 texPage) {
+INLINE uint16_t tex8bit(const Render::Target& target, ivec2 tex, ivec2 texPage) {
     uint16_t index = gpuVRAM[(texPage.y + tex.y) & 511][(texPage.x + tex.x / 2) & 1023];
     uint8_t entry = (index >> ((tex.x & 1) * 8)) & 0xff;
-    return gpu->clutCache[entry];
+    return target.clutCache->entries[entry];
 }
 
-INLINE uint16_t tex16bit(gpu::GPU* gpu, ivec2 tex, ivec2 texPage) { return gpuVRAM[(texPage.y + tex.y) & 511][(texPage.x + tex.x) & 1023]; }
+INLINE uint16_t tex16bit(const Render::Target& target, ivec2 tex, ivec2 texPage) {
+    return gpuVRAM[(texPage.y + tex.y) & 511][(texPage.x + tex.x) & 1023];
+}
 
 template <ColorDepth bits>
-INLINE PSXColor fetchTex(gpu::GPU* gpu, ivec2 texel, const ivec2 texPage) {
+INLINE PSXColor fetchTex(const Render::Target& target, ivec2 texel, const ivec2 texPage) {
     if constexpr (bits == ColorDepth::BIT_4) {
-        return tex4bit(gpu, texel, texPage);
+        return tex4bit(target, texel, texPage);
     } else if constexpr (bits == ColorDepth::BIT_8) {
-        return tex8bit(gpu, texel, texPage);
+        return tex8bit(target, texel, texPage);
     } else if constexpr (bits == ColorDepth::BIT_16) {
-        return tex16bit(gpu, texel, texPage);
+        return tex16bit(target, texel, texPage);
     } else {
         static_assert(true, "Invalid ColorDepth parameter");
     }
@@ -15,6 +15,7 @@ bool Interrupt::interruptPending() { return (status._reg & mask._reg) ? true : f
 void Interrupt::step() {
     // notify cop0
     sys->cpu->cop0.cause.interruptPending = interruptPending() ? 4 : 0;
+    sys->cpu->updateInterruptPending();
 }
 
 uint8_t Interrupt::read(uint32_t address) {
@@ -30,4 +31,22 @@ void Interrupt::write(uint32_t address, uint8_t data) {
     if (address >= 0x4 && address < 0x6) mask._byte[address - 4] = data;
 
     step();
-}
\ No newline at end of file
+}
+
+uint16_t Interrupt::read16(uint32_t address) {
+    if (address == 0) return status._reg;
+    if (address == 4) return mask._reg;
+    return 0;
+}
+
+uint32_t Interrupt::read32(uint32_t address) { return read16(address); }
+
+void Interrupt::write16(uint32_t address, uint16_t data) {
+    if (address == 0) status._reg &= data;  // write 0 to ACK
+    if (address == 4) mask._reg = data;
+
+    step();
+}
+
+// Upper halfword of registers is unused
+void Interrupt::write32(uint32_t address, uint32_t data) { write16(address, data); }
@@ -52,6 +52,10 @@ class Interrupt {
     void step();
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
+    uint16_t read16(uint32_t address);
+    uint32_t read32(uint32_t address);
+    void write16(uint32_t address, uint16_t data);
+    void write32(uint32_t address, uint32_t data);
 
     void trigger(interrupt::IrqNumber irq);
     bool interruptPending();
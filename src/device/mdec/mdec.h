@@ -60,6 +60,12 @@ class MDEC {
     std::vector<uint16_t> input;
     std::vector<uint32_t> output;
     size_t outputPtr;
+    int part = 0;  // 24bit output - word of 3 word cycle
+
+    // Blocks of currently decoded macroblock
+    std::array<int16_t, 64> crblk = {{0}};
+    std::array<int16_t, 64> cbblk = {{0}};
+    std::array<int16_t, 64> yblk[4] = {{0}};
 
     void reset();
 
@@ -71,7 +77,7 @@ class MDEC {
     void idct(std::array<int16_t, 64>& src);
 
    public:
-    MDEC();
+    MDEC(int verbose);
     void step();
     uint32_t read(uint32_t address);
     void handleCommand(uint8_t cmd, uint32_t data);
@@ -1,5 +1,6 @@
 #include "spu.h"
 #include <fmt/core.h>
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <vector>
@@ -11,12 +12,11 @@
 #include "system.h"
 #include "utils/file.h"
 #include "utils/math.h"
-#include "config.h"
 
 using namespace spu;
 
 SPU::SPU(System* sys) : sys(sys) {
-    verbose = config.debug.log.spu;
+    verbose = sys->config.debug.log.spu;
     ram.fill(0);
     audioBufferPos = 0;
     captureBufferIndex = 0;
@@ -455,16 +455,7 @@ void SPU::write(uint32_t address, uint8_t data) {
 
     if (address >= 0x1f801daa && address <= 0x1f801dab) {  // SPUCNT
         control._byte[address - 0x1f801daa] = data;
-
-        status.currentMode = control._reg & 0x3f;
-        if (!control.irqEnable) {
-            status.irqFlag = false;
-        }
-        if (!control.spuEnable) {
-            for (auto& v : voices) {
-                v.adsrVolume._reg = 0;
-            }
-        }
+        controlWritten();
         return;
     }
 
@@ -493,6 +484,42 @@ void SPU::write(uint32_t address, uint8_t data) {
     fmt::print("[SPU] Unhandled write at 0x{:08x}: 0x{:02x}\n", address, data);
 }
 
+void SPU::controlWritten() {
+    status.currentMode = control._reg & 0x3f;
+    if (!control.irqEnable) {
+        status.irqFlag = false;
+    }
+    if (!control.spuEnable) {
+        for (auto& v : voices) {
+            v.adsrVolume._reg = 0;
+        }
+    }
+}
+
+uint16_t SPU::read16(uint32_t address) {
+    switch (address + BASE_ADDRESS) {
+        case 0x1f801daa: return control._reg;
+        case 0x1f801dac: return dataTransferControl._reg;
+        case 0x1f801dae: return status._reg;
+        default: return read(address) | read(address + 1) << 8;
+    }
+}
+
+void SPU::write16(uint32_t address, uint16_t data) {
+    switch (address + BASE_ADDRESS) {
+        case 0x1f801daa:  // SPUCNT
+            if (verbose) fmt::print("[SPU] W 0x{:08x}: 0x{:04x}\n", address + BASE_ADDRESS, data);
+            control._reg = data;
+            controlWritten();
+            return;
+        case 0x1f801dac: dataTransferControl._reg = data; return;
+        default:
+            write(address, data & 0xff);
+            write(address + 1, data >> 8);
+            return;
+    }
+}
+
 uint8_t SPU::memoryRead8(uint32_t address) {
     if (control.irqEnable && address == irqAddress._reg * 8) {
         status.irqFlag = true;
@@ -527,6 +554,44 @@ std::array<uint8_t, 16> SPU::readBlock(uint32_t address) {
     return buf;
 }
 
+void SPU::dmaRead(uint8_t* data, size_t size) {
+    while (size > 0) {
+        if (currentDataAddress >= RAM_SIZE) {
+            currentDataAddress %= RAM_SIZE;
+        }
+
+        size_t n = std::min<size_t>(size, RAM_SIZE - currentDataAddress);
+        checkIrq(currentDataAddress, n);
+        std::copy_n(ram.begin() + currentDataAddress, n, data);
+        currentDataAddress += n;
+        data += n;
+        size -= n;
+    }
+}
+
+void SPU::dmaWrite(const uint8_t* data, size_t size) {
+    while (size > 0) {
+        if (currentDataAddress >= RAM_SIZE) {
+            currentDataAddress %= RAM_SIZE;
+        }
+
+        size_t n = std::min<size_t>(size, RAM_SIZE - currentDataAddress);
+        std::copy_n(data, n, ram.begin() + currentDataAddress);
+        checkIrq(currentDataAddress, n);
+        currentDataAddress += n;
+        data += n;
+        size -= n;
+    }
+}
+
+void SPU::checkIrq(uint32_t address, size_t size) {
+    // Unsigned difference - single comparison checks whether IRQ address lies in range
+    if (control.irqEnable && (uint32_t)(irqAddress._reg * 8) - address < size) {
+        status.irqFlag = true;
+        sys->interrupt->trigger(interrupt::SPU);
+    }
+}
+
 void SPU::dumpRam() {
     std::vector<uint8_t> ram;
     ram.assign(this->ram.begin(), this->ram.end());
@@ -67,11 +67,19 @@ struct SPU {
     void step(device::cdrom::CDROM* cdrom);
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
+    // Registers are 16bit wide, SPUCNT written byte by byte would pass through partially updated state
+    uint16_t read16(uint32_t address);
+    void write16(uint32_t address, uint16_t data);
+    void controlWritten();
 
     uint8_t memoryRead8(uint32_t address);
     void memoryWrite8(uint32_t address, uint8_t data);
     void memoryWrite16(uint32_t address, uint16_t data);
     std::array<uint8_t, 16> readBlock(uint32_t address);
+    // DMA through data FIFO, equivalent to byte by byte access at 0x1f801da8
+    void dmaRead(uint8_t* data, size_t size);
+    void dmaWrite(const uint8_t* data, size_t size);
+    void checkIrq(uint32_t address, size_t size);
     void dumpRam();
 
     template <class Archive>
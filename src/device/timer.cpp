@@ -3,66 +3,113 @@
 #include "system.h"
 
 namespace device::timer {
-
 Timer::Timer(System* sys, int which) : which(which), sys(sys) {}
 
-void Timer::step(int cycles) {
-    if (paused) return;
-    cnt += cycles;
-
-    uint32_t tval = current._reg;
-    if (which == 0) {
-        auto clock = static_cast<CounterMode::ClockSource0>(mode.clockSource & 1);
-        using modes = CounterMode::ClockSource0;
-
-        if (clock == modes::dotClock) {
-            tval += cnt / 6;
-            cnt %= 6;
-        } else {  // System Clock
-            tval += (int)(cnt / 1.5f);
-            cnt %= (int)1.5f;
-        }
-    } else if (which == 1) {
-        auto clock = static_cast<CounterMode::ClockSource1>(mode.clockSource & 1);
-        using modes = CounterMode::ClockSource1;
-
-        if (clock == modes::hblank) {
-            tval += cnt / 3413;
-            cnt %= 3413;
-        } else {  // System Clock
-            tval += (int)(cnt / 1.5f);
-            cnt %= (int)1.5f;
-        }
-    } else if (which == 2) {
-        auto clock = static_cast<CounterMode::ClockSource2>((mode.clockSource >> 1) & 1);
-        using modes = CounterMode::ClockSource2;
-
-        if (clock == modes::systemClock_8) {
-            tval += (int)(cnt / (8 * 1.5f));
-            cnt %= (int)(8 * 1.5f);
-        } else {  // System Clock
-            tval += (int)(cnt * 1.5f);
-            cnt %= (int)1.5f;
+void Timer::sync() {
+    uint64_t now = sys->scheduler->now();
+    step(now - lastSync);
+    lastSync = now;
+}
+
+void Timer::scheduleIrq() {
+    auto event = static_cast<Scheduler::Event>((int)Scheduler::Event::timer0 + which);
+    uint64_t ticks = 0;
+    if (!paused) {
+        if (mode.irqWhenTarget) ticks = ticksUntil(target._reg);
+        if (mode.irqWhenFFFF) {
+            uint64_t ffff = ticksUntil(0xffff);
+            if (ffff != 0 && (ticks == 0 || ffff < ticks)) ticks = ffff;
         }
     }
 
-    bool possibleIrq = false;
+    if (ticks == 0) {
+        sys->scheduler->cancel(event);
+        return;
+    }
+    sys->scheduler->schedule(event, cyclesForTicks(ticks));
+}
 
-    if (tval >= target._reg) {
-        mode.reachedTarget = true;
-        if (mode.resetToZero == CounterMode::ResetToZero::whenTarget) tval = 0;
-        if (mode.irqWhenTarget) possibleIrq = true;
+// Counter rate as a fraction of system clock (3 system cycles per CPU instruction, 1.5 per CPU clock)
+Timer::Rate Timer::rate() const {
+    if (which == 0 && static_cast<CounterMode::ClockSource0>(mode.clockSource & 1) == CounterMode::ClockSource0::dotClock) {
+        return {1, 6};
+    }
+    if (which == 1 && static_cast<CounterMode::ClockSource1>(mode.clockSource & 1) == CounterMode::ClockSource1::hblank) {
+        return {1, 3413};
+    }
+    if (which == 2 && static_cast<CounterMode::ClockSource2>((mode.clockSource >> 1) & 1) == CounterMode::ClockSource2::systemClock_8) {
+        return {1, 12};
     }
+    return {2, 3};
+}
+
+// Inverse of step() - minimal number of cycles to advance counter by given ticks
+uint64_t Timer::cyclesForTicks(uint64_t ticks) const {
+    Rate r = rate();
+    return (ticks * r.den - cnt + r.num - 1) / r.num;
+}
 
-    if (tval >= 0xffff) {
-        mode.reachedFFFF = true;
-        if (mode.resetToZero == CounterMode::ResetToZero::whenFFFF) tval = 0;
-        if (mode.irqWhenFFFF) possibleIrq = true;
+// Counter restarts from 0 after reaching target (if reset at target is enabled and it wasn't already passed) or 0xffff
+uint32_t Timer::wrapPoint(uint32_t value) const {
+    if (mode.resetToZero == CounterMode::ResetToZero::whenTarget && value <= target._reg) return target._reg;
+    return 0xffff;
+}
+
+uint64_t Timer::ticksUntil(uint32_t value) const {
+    uint32_t counter = current._reg;
+    uint32_t wrap = wrapPoint(counter);
+    if (counter < value && value <= wrap) return value - counter;
+
+    // After first wrap counter runs from 0
+    if (value > wrapPoint(0)) return 0;
+    return wrap - counter + 1 + value;
+}
+
+void Timer::step(uint64_t cycles) {
+    if (paused) return;
+
+    // Fraction of a tick is carried in cnt, no cycles are lost between syncs
+    Rate r = rate();
+    uint64_t sum = cnt + cycles * r.num;
+    cnt = sum % r.den;
+    advance(sum / r.den);
+}
+
+void Timer::advance(uint64_t ticks) {
+    if (ticks == 0) return;
+
+    uint32_t value = current._reg;
+    uint32_t wrap = wrapPoint(value);
+    bool hitTarget = false;
+    bool hitFFFF = false;
+
+    if (ticks <= wrap - value) {
+        uint32_t next = value + (uint32_t)ticks;
+        hitTarget = value < target._reg && target._reg <= next;
+        hitFFFF = next == 0xffff;
+        value = next;
+    } else {
+        hitTarget = value < target._reg;
+        hitFFFF = wrap == 0xffff && value < 0xffff;
+        ticks -= wrap - value + 1;
+
+        // Whole periods pass through both points
+        uint32_t period = wrapPoint(0) + 1;
+        if (ticks >= period) {
+            hitTarget = true;
+            hitFFFF |= period == 0x10000;
+            ticks %= period;
+        }
+        value = (uint32_t)ticks;
+        hitTarget |= target._reg <= value;
+        hitFFFF |= value == 0xffff;
     }
 
-    if (possibleIrq) checkIrq();
+    if (hitTarget) mode.reachedTarget = true;
+    if (hitFFFF) mode.reachedFFFF = true;
+    if ((hitTarget && mode.irqWhenTarget) || (hitFFFF && mode.irqWhenFFFF)) checkIrq();
 
-    current._reg = (uint16_t)tval;
+    current._reg = (uint16_t)value;
 }
 
 void Timer::checkIrq() {
@@ -81,7 +128,36 @@ void Timer::checkIrq() {
     mode.interruptRequest = true;  // low only for few cycles
 }
 
+void Timer::modeWritten() {
+    oneShotIrqOccured = false;
+    mode.interruptRequest = true;
+    if (mode.syncEnabled) {
+        if (which == 0) {
+            using modes = CounterMode::SyncMode0;
+            auto mode0 = static_cast<CounterMode::SyncMode0>(mode.syncMode);
+            if (mode0 == modes::pauseUntilHblankAndFreerun) paused = true;
+
+            fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode0);
+        }
+        if (which == 1) {
+            using modes = CounterMode::SyncMode1;
+            auto mode1 = static_cast<CounterMode::SyncMode1>(mode.syncMode);
+            if (mode1 == modes::pauseUntilVblankAndFreerun) paused = true;
+
+            fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode1);
+        }
+        if (which == 2) {
+            using modes = CounterMode::SyncMode2;
+            auto mode2 = static_cast<CounterMode::SyncMode2>(mode.syncMode);
+            if (mode2 == modes::stopCounter || mode2 == modes::stopCounter_) paused = true;
+
+            fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode2);
+        }
+    }
+}
+
 uint8_t Timer::read(uint32_t address) {
+    sync();
     if (address < 2) {
         return current.read(address);
     }
@@ -100,43 +176,55 @@ uint8_t Timer::read(uint32_t address) {
 }
 
 void Timer::write(uint32_t address, uint8_t data) {
+    sync();
     if (address < 2) {
         current.write(address, data);
     } else if (address >= 4 && address < 6) {
         current._reg = 0;
+        cnt = 0;
         mode.write(address - 4, data);  // BIOS uses 0x0148 for TIMER1
 
         paused = false;
-        if (address == 5) {
-            oneShotIrqOccured = false;
-            mode.interruptRequest = true;
-            if (mode.syncEnabled) {
-                if (which == 0) {
-                    using modes = CounterMode::SyncMode0;
-                    auto mode0 = static_cast<CounterMode::SyncMode0>(mode.syncMode);
-                    if (mode0 == modes::pauseUntilHblankAndFreerun) paused = true;
-
-                    fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode0);
-                }
-                if (which == 1) {
-                    using modes = CounterMode::SyncMode1;
-                    auto mode1 = static_cast<CounterMode::SyncMode1>(mode.syncMode);
-                    if (mode1 == modes::pauseUntilVblankAndFreerun) paused = true;
-
-                    fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode1);
-                }
-                if (which == 2) {
-                    using modes = CounterMode::SyncMode2;
-                    auto mode2 = static_cast<CounterMode::SyncMode2>(mode.syncMode);
-                    if (mode2 == modes::stopCounter || mode2 == modes::stopCounter_) paused = true;
-
-                    fmt::print("[Timer{}]: Synchronization enabled: {}\n", which, (int)mode2);
-                }
-            }
-        }
+        if (address == 5) modeWritten();
     } else if (address >= 8 && address < 10) {
         target.write(address - 8, data);
     }
+    scheduleIrq();
 }
 
+uint16_t Timer::read16(uint32_t address) {
+    sync();
+    if (address == 0) return current._reg;
+    if (address == 4) {
+        uint16_t v = mode._reg;
+        mode.reachedFFFF = false;
+        mode.reachedTarget = false;
+        return v;
+    }
+    if (address == 8) return target._reg;
+    return 0;
+}
+
+uint32_t Timer::read32(uint32_t address) { return read16(address); }
+
+void Timer::write16(uint32_t address, uint16_t data) {
+    sync();
+    if (address == 0) {
+        current._reg = data;
+    } else if (address == 4) {
+        current._reg = 0;
+        cnt = 0;
+        mode._reg = data;
+
+        paused = false;
+        modeWritten();
+    } else if (address == 8) {
+        target._reg = data;
+    }
+    scheduleIrq();
+}
+
+// Upper halfword of registers is unused
+void Timer::write32(uint32_t address, uint32_t data) { write16(address, data); }
+
 };  // namespace device::timer
\ No newline at end of file
@@ -78,14 +78,30 @@ class Timer {
     Reg16 target;
 
     bool paused = false;
-    uint32_t cnt = 0;
+    uint32_t cnt = 0;  // Fraction of tick carried between syncs, in 1/den units
 
    private:
     bool oneShotIrqOccured = false;
+    uint64_t lastSync = 0;  // Scheduler time of last step, counter value is computed on access
 
     System* sys;
 
+    // Counter ticks per system cycle, num / den
+    struct Rate {
+        uint32_t num;
+        uint32_t den;
+    };
+
+    Rate rate() const;
+    void step(uint64_t cycles);
+    void advance(uint64_t ticks);
     void checkIrq();
+    uint64_t cyclesForTicks(uint64_t ticks) const;
+    uint32_t wrapPoint(uint32_t value) const;
+    // Ticks until counter reaches given value, 0 if it never does
+    uint64_t ticksUntil(uint32_t value) const;
+    // Side effects of writing upper byte of mode register
+    void modeWritten();
     interrupt::IrqNumber mapIrqNumber() const {
         if (which == 0) return interrupt::TIMER0;
         if (which == 1) return interrupt::TIMER1;
@@ -96,13 +112,20 @@ class Timer {
 
    public:
     Timer(System* sys, int which);
-    void step(int cycles);
+    // Catch up with current scheduler time
+    void sync();
+    // Schedule event at next target/0xffff IRQ (if enabled)
+    void scheduleIrq();
     uint8_t read(uint32_t address);
     void write(uint32_t address, uint8_t data);
+    uint16_t read16(uint32_t address);
+    uint32_t read32(uint32_t address);
+    void write16(uint32_t address, uint16_t data);
+    void write32(uint32_t address, uint32_t data);
 
     template <class Archive>
     void serialize(Archive& ar) {
-        ar(current, mode._reg, target, cnt, oneShotIrqOccured);
+        ar(current, mode._reg, target, cnt, oneShotIrqOccured, lastSync);
     }
 };
 };  // namespace device::timer
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "fastmem.h"
+#include <fmt/core.h>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include "system.h"
+
+#if defined(__linux__) && defined(__x86_64__)
+#define FASTMEM_ARENA
+#include <signal.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Storage layout, every region starts at page boundary
+const size_t RAM_OFFSET = 0;
+const size_t BIOS_OFFSET = RAM_OFFSET + System::RAM_SIZE;
+const size_t EXPANSION_OFFSET = BIOS_OFFSET + System::BIOS_SIZE;
+const size_t SCRATCHPAD_OFFSET = EXPANSION_OFFSET + System::EXPANSION_SIZE;
+const size_t STORAGE_SIZE = SCRATCHPAD_OFFSET + System::PAGE_SIZE;  // Scratchpad is padded to full page
+
+const uint64_t SEGMENT_SIZE = 0x2000'0000;
+
+#ifdef FASTMEM_ARENA
+// Arenas of all Systems in process, slots are claimed atomically - signal handler can read them without locking
+const size_t MAX_ARENAS = 64;
+std::array<std::atomic<Fastmem*>, MAX_ARENAS> activeArenas{};
+struct sigaction previousHandler;
+
+void faultHandler(int sig, siginfo_t* info, void* context) {
+    UNUSED(sig);
+    auto ctx = (ucontext_t*)context;
+    auto rip = (const uint8_t*)ctx->uc_mcontext.gregs[REG_RIP];
+
+    for (auto& slot : activeArenas) {
+        auto fastmem = slot.load();
+        if (fastmem == nullptr) continue;
+        if (auto handler = fastmem->findSlowPath(rip, (const uint8_t*)info->si_addr)) {
+            ctx->uc_mcontext.gregs[REG_RIP] = (greg_t)handler;
+            return;
+        }
+    }
+
+    // Not caused by arena access - restore previous handler, faulting instruction will be executed again
+    sigaction(SIGSEGV, &previousHandler, nullptr);
+}
+#endif
+}  // namespace
+
+Fastmem::Fastmem() {
+#ifdef FASTMEM_ARENA
+    fd = memfd_create("avocado-memory", MFD_CLOEXEC);
+    if (fd != -1 && ftruncate(fd, STORAGE_SIZE) == 0) {
+        void* ptr = mmap(nullptr, STORAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr != MAP_FAILED) storage = (uint8_t*)ptr;
+    }
+    if (storage == nullptr) {
+        fmt::print("[FASTMEM] Unable to create shared memory, fastmem disabled\n");
+        if (fd != -1) close(fd);
+        fd = -1;
+    }
+#endif
+    if (storage == nullptr) {
+        storage = new uint8_t[STORAGE_SIZE]();
+    }
+
+    ram = storage + RAM_OFFSET;
+    bios = storage + BIOS_OFFSET;
+    expansion = storage + EXPANSION_OFFSET;
+    scratchpad = storage + SCRATCHPAD_OFFSET;
+}
+
+Fastmem::~Fastmem() {
+    disable();
+#ifdef FASTMEM_ARENA
+    if (fd != -1) {
+        munmap(storage, STORAGE_SIZE);
+        close(fd);
+        return;
+    }
+#endif
+    delete[] storage;
+}
+
+bool Fastmem::enable() {
+    if (arena != nullptr) return true;
+    if (!isSupported()) return false;
+#ifdef FASTMEM_ARENA
+    void* ptr = mmap(nullptr, ARENA_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        fmt::print("[FASTMEM] Unable to reserve address space\n");
+        return false;
+    }
+    arena = (uint8_t*)ptr;
+
+    if (!mapArena()) {
+        fmt::print("[FASTMEM] Unable to map guest memory\n");
+        disable();
+        return false;
+    }
+
+    installFaultHandler();
+    for (auto& slot : activeArenas) {
+        Fastmem* empty = nullptr;
+        if (slot.compare_exchange_strong(empty, this)) return true;
+    }
+    fmt::print("[FASTMEM] Too many active arenas\n");
+    disable();
+    return false;
+#else
+    return false;
+#endif
+}
+
+void Fastmem::disable() {
+    if (arena == nullptr) return;
+#ifdef FASTMEM_ARENA
+    for (auto& slot : activeArenas) {
+        Fastmem* self = this;
+        slot.compare_exchange_strong(self, nullptr);
+    }
+    munmap(arena, ARENA_SIZE);
+#endif
+    arena = nullptr;
+    slowPaths.clear();
+}
+
+bool Fastmem::mapArena() {
+#ifdef FASTMEM_ARENA
+    auto map = [&](uint64_t address, size_t offset, size_t size, int prot) {
+        void* ptr = mmap(arena + address, size, prot, MAP_SHARED | MAP_FIXED, fd, offset);
+        return ptr != MAP_FAILED;
+    };
+
+    for (uint64_t segment = 0; segment < ARENA_SIZE; segment += SEGMENT_SIZE) {
+        bool ok = true;
+        for (uint32_t mirror = 0; mirror < 4; mirror++) {
+            ok &= map(segment + System::RAM_BASE + mirror * System::RAM_SIZE, RAM_OFFSET, System::RAM_SIZE, PROT_READ | PROT_WRITE);
+        }
+        ok &= map(segment + System::EXPANSION_BASE, EXPANSION_OFFSET, System::EXPANSION_SIZE, PROT_READ | PROT_WRITE);
+        ok &= map(segment + System::SCRATCHPAD_BASE, SCRATCHPAD_OFFSET, System::PAGE_SIZE, PROT_READ | PROT_WRITE);
+        ok &= map(segment + System::BIOS_BASE, BIOS_OFFSET, System::BIOS_SIZE, PROT_READ);
+        if (!ok) return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Fastmem::installFaultHandler() {
+#ifdef FASTMEM_ARENA
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        struct sigaction action = {};
+        action.sa_sigaction = faultHandler;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &previousHandler);
+    });
+#endif
+}
+
+void Fastmem::protectRamPage(uint32_t page, bool protect) {
+    if (arena == nullptr) return;
+#ifdef FASTMEM_ARENA
+    int prot = protect ? PROT_READ : PROT_READ | PROT_WRITE;
+    for (uint64_t segment = 0; segment < ARENA_SIZE; segment += SEGMENT_SIZE) {
+        for (uint32_t mirror = 0; mirror < 4; mirror++) {
+            mprotect(arena + segment + System::RAM_BASE + mirror * System::RAM_SIZE + page * System::PAGE_SIZE, System::PAGE_SIZE, prot);
+        }
+    }
+#else
+    UNUSED(page);
+    UNUSED(protect);
+#endif
+}
+
+void Fastmem::addSlowPath(const uint8_t* access, const uint8_t* handler) { slowPaths[access] = handler; }
+
+void Fastmem::clearSlowPaths() { slowPaths.clear(); }
+
+const uint8_t* Fastmem::findSlowPath(const uint8_t* access, const uint8_t* faultAddress) const {
+    if (arena == nullptr || faultAddress < arena || faultAddress >= arena + ARENA_SIZE) return nullptr;
+    auto it = slowPaths.find(access);
+    if (it == slowPaths.end()) return nullptr;
+    return it->second;
+}
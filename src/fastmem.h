@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+Backing storage for guest memory (RAM, BIOS, scratchpad, expansion).
+
+On Linux the storage is a memfd which can be additionally mapped into
+a reserved 4GB host range (arena) reproducing whole PSX address space -
+every 512MB segment (KUSEG, KSEG0, KSEG1, ...) maps physical memory
+with all four RAM mirrors. Guest access becomes single host access at arena + address.
+Everything else in the arena (I/O, unmapped regions, write to BIOS or RAM pages
+with compiled code) is left inaccessible - host code accessing it faults
+and SIGSEGV handler redirects it to registered slow path, which goes through System.
+
+Other platforms use plain heap allocation and arena is not available.
+*/
+class Fastmem {
+   public:
+    static const uint64_t ARENA_SIZE = 0x1'0000'0000;
+
+   private:
+    uint8_t* storage = nullptr;
+    int fd = -1;
+    uint8_t* arena = nullptr;
+
+    // Host instruction accessing arena -> code handling the access through System
+    std::unordered_map<const uint8_t*, const uint8_t*> slowPaths;
+
+    bool mapArena();
+    void installFaultHandler();
+
+   public:
+    uint8_t* ram;
+    uint8_t* bios;
+    uint8_t* scratchpad;
+    uint8_t* expansion;
+
+    Fastmem();
+    ~Fastmem();
+
+    // Returns nullptr when disabled
+    uint8_t* getArena() const { return arena; }
+    bool isSupported() const { return fd != -1; }
+    bool enable();
+    void disable();
+
+    // Mirrors page table protection of RAM pages containing compiled code
+    void protectRamPage(uint32_t page, bool protect);
+
+    void addSlowPath(const uint8_t* access, const uint8_t* handler);
+    void clearSlowPaths();
+
+    // Called from signal handler
+    const uint8_t* findSlowPath(const uint8_t* access, const uint8_t* faultAddress) const;
+};
@@ -1,4 +1,5 @@
 #include "input_manager.h"
+#include <fmt/core.h>
 
 InputManager* InputManager::_instance = nullptr;
 
@@ -16,6 +17,17 @@ InputManager::AnalogValue InputManager::getAnalog(const std::string& key) {
     return {};
 }
 
+void InputManager::setState(const std::string& key, AnalogValue value) {
+    if (!updates.push({key, value})) {
+        fmt::print("[INPUT] Update queue full, dropping {}\n", key);
+    }
+}
+
+void InputManager::applyUpdates() {
+    Update update;
+    while (updates.pop(update)) state[update.key] = update.value;
+}
+
 void InputManager::setInstance(InputManager* inputManager) { _instance = inputManager; }
 
 InputManager* InputManager::getInstance() { return _instance; }
\ No newline at end of file
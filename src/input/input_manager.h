@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include "utils/spsc_queue.h"
 
 class InputManager {
    public:
@@ -15,15 +16,27 @@ class InputManager {
     };
 
    private:
+    struct Update {
+        std::string key;
+        AnalogValue value;
+    };
+
     const int DIGITAL_THRESHOLD = UINT8_MAX / 4;
     static InputManager* _instance;
 
+    // Changes made by frontend thread, emulation picks them up in applyUpdates()
+    SpscQueue<Update, 1024> updates;
+
    protected:
     std::unordered_map<std::string, AnalogValue> state;
 
+    void setState(const std::string& key, AnalogValue value);
+
    public:
     bool getDigital(const std::string& key);
     AnalogValue getAnalog(const std::string& key);
+    // Called by emulation before peripherals read the state
+    void applyUpdates();
 
     static void setInstance(InputManager* inputManager);
     static InputManager* getInstance();
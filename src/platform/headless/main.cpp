@@ -1,45 +1,192 @@
-#include <cassert>
-#include <cstdio>
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdlib>
+#include <magic_enum.hpp>
 #include <memory>
 #include <string>
-#include "mips.h"
-#include "utils/file.h"
+#include "bios/hle.h"
+#include "config.h"
+#include "system.h"
+#include "system_tools.h"
 
-int main(int argc, char **argv) {
-    if (argc < 2) {
-        printf("usage: Avocado psx.exe\n");
-        return 1;
+// Headless frontend - runs disc image, .exe or .psf without window, input and sound.
+// Used for benchmarks and regression runs (per frame hashes of displayed image).
+namespace {
+struct Options {
+    std::string bios = "data/bios/scph1001.bin";
+    std::string file;
+    int frames = 0;
+    double seconds = 0.0;
+    int frameSkip = 0;
+    int threads = 0;
+    bool gpuThread = false;
+    bool render = false;
+    bool hash = false;
+    bool profile = false;
+    bool fastmem = false;
+    bool hle = false;
+    CpuMode cpuMode = CpuMode::interpreter;
+};
+
+void usage() {
+    fmt::print(
+        "usage: avocado_headless [options] file\n"
+        "  file               disc image, .exe or .psf\n"
+        "  --bios PATH        BIOS image (default data/bios/scph1001.bin)\n"
+        "  --frames N         emulate N frames (default 600)\n"
+        "  --seconds S        emulate S seconds of console time\n"
+        "  --render           rasterize in software (disabled by default)\n"
+        "  --frame-skip N     present only every (N+1)th frame, rasterize only what is observed\n"
+        "  --threads N        rasterize on N threads\n"
+        "  --gpu-thread       execute GPU commands on separate thread\n"
+        "  --hash             print hash of displayed VRAM area for every presented frame (implies --render)\n"
+        "  --profile          report host time spent in each subsystem\n"
+        "  --cpu MODE         interpreter, cachedInterpreter, threadedInterpreter or jit\n"
+        "  --fastmem          enable fastmem\n"
+        "  --hle              replace BIOS library routines with native ones\n");
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--bios" && hasValue) {
+            options.bios = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (arg == "--frame-skip" && hasValue) {
+            options.frameSkip = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--cpu" && hasValue) {
+            auto mode = magic_enum::enum_cast<CpuMode>(argv[++i]);
+            if (!mode) return false;
+            options.cpuMode = *mode;
+        } else if (arg == "--gpu-thread") {
+            options.gpuThread = true;
+        } else if (arg == "--render") {
+            options.render = true;
+        } else if (arg == "--hash") {
+            options.hash = true;
+            options.render = true;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--fastmem") {
+            options.fastmem = true;
+        } else if (arg == "--hle") {
+            options.hle = true;
+        } else if (arg.rfind("--", 0) != 0 && options.file.empty()) {
+            options.file = arg;
+        } else {
+            return false;
+        }
     }
-    std::unique_ptr<mips::CPU> cpu = std::make_unique<mips::CPU>();
 
-    if (!cpu->loadBios("SCPH1001.BIN")) {
-        return 1;
+    if (options.frames <= 0 && options.seconds <= 0.0) options.frames = 600;
+    return !options.file.empty();
+}
+
+// FNV-1a of VRAM area currently sent to the display
+uint64_t displayHash(gpu::GPU* gpu) {
+    gpu->synchronize();
+
+    int width = gpu->gp1_08.getHorizontalResoulution();
+    int height = gpu->gp1_08.getVerticalResoulution();
+    // 24bit pixels are packed, 2 pixels take 3 halfwords
+    if (gpu->gp1_08.colorDepth == gpu::GP1_08::ColorDepth::bit24) width = width * 3 / 2;
+
+    uint64_t hash = 0xcbf29ce484222325;
+    for (int y = 0; y < height; y++) {
+        int row = ((gpu->displayAreaStartY + y) % gpu::VRAM_HEIGHT) * gpu::VRAM_WIDTH;
+        for (int x = 0; x < width; x++) {
+            uint16_t pixel = gpu->vram[row + (gpu->displayAreaStartX + x) % gpu::VRAM_WIDTH];
+            hash = (hash ^ (pixel & 0xff)) * 0x100000001b3;
+            hash = (hash ^ (pixel >> 8)) * 0x100000001b3;
+        }
     }
+    return hash;
+}
 
-    // Breakpoint on BIOS Shell execution
-    cpu->addBreakpoint(0x80030000);
+void report(System* sys, int frames, double emulatedSeconds, double hostSeconds) {
+    fmt::print("frames:   {} ({:.2f} s emulated) in {:.3f} s\n", frames, emulatedSeconds, hostSeconds);
+    fmt::print("speed:    {:.1f} fps, {:.0f}% of real time\n", frames / hostSeconds, emulatedSeconds / hostSeconds * 100.0);
 
-    cpu->biosLog = false;
-    cpu->debugOutput = false;
+    if (!sys->profiler.isEnabled()) return;
+    sys->profiler.disable();
 
-    // Emulate BIOS to GUI breakpoint
-    while (cpu->state == mips::CPU::State::run) {
-        cpu->emulateFrame();
+    double total = 0.0;
+    for (size_t i = 0; i < Profiler::SECTION_COUNT; i++) {
+        total += std::chrono::duration<double>(sys->profiler.get((Profiler::Section)i)).count();
     }
 
-    if (!cpu->loadExeFile(argv[1])) {
-        printf("Cannot load %s\n", argv[1]);
+    for (size_t i = 0; i < Profiler::SECTION_COUNT; i++) {
+        auto section = (Profiler::Section)i;
+        double seconds = std::chrono::duration<double>(sys->profiler.get(section)).count();
+        fmt::print("  {:<12}{:>10.1f} ms {:>6.1f}%\n", Profiler::name(section), seconds * 1000.0, total > 0 ? seconds / total * 100.0 : 0.0);
+    }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    avocado_config_t settings;
+    settings.bios = options.bios;
+    settings.options.graphics.renderingMode = options.render ? RenderingMode::software : (RenderingMode)0;
+    settings.options.graphics.frameSkip = options.frameSkip;
+    settings.options.graphics.rendererThreads = options.threads;
+    settings.options.graphics.gpuThread = options.gpuThread;
+    settings.options.emulator.cpuMode = options.cpuMode;
+    settings.options.emulator.fastmem = options.fastmem;
+    if (options.hle) {
+        for (const auto& option : bios::hle::options()) settings.options.emulator.hle[option] = true;
+    }
+    settings.debug.log.system = 0;
+    settings.memoryCard[0].path = "";  // Runs have to be repeatable, no memory card state from previous sessions
+
+    // No GUI shows toasts, core messages (load errors, emulation stopped) go to console
+    auto bus = std::make_shared<Dexode::EventBus>();
+    bus->listen<Event::Gui::Toast>([](auto e) { fmt::print("{}\n", e.message); });
+
+    auto sys = system_tools::hardReset(settings, bus);
+    if (!sys->isSystemReady()) {
+        fmt::print("Cannot load BIOS {}\n", options.bios);
         return 1;
     }
-    printf("File %s loaded\n", getFilenameExt(argv[1]).c_str());
 
-    cpu->state = System::State::run;
-    cpu->debugOutput = false;
-    cpu->setPC(cpu->readMemory32(0x1f000000));
+    sys->state = System::State::run;
+    // Measuring BIOS shell instead of requested file would give misleading numbers
+    if (!system_tools::loadFile(sys, options.file)) return 1;
+    sys->gpu->gpuLogEnabled = false;  // Draw list debugging needs every frame rasterized
+    if (options.profile) sys->profiler.enable();
+
+    int frames = 0;
+    double emulatedSeconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (sys->state == System::State::run) {
+        if (options.frames > 0 && frames >= options.frames) break;
+        if (options.seconds > 0.0 && emulatedSeconds >= options.seconds) break;
 
-    while (cpu->state == System::State::run) {
-        cpu->emulateFrame();
+        sys->emulateFrame();
+        frames++;
+        emulatedSeconds += sys->gpu->isNtsc() ? 1.0 / 60.0 : 1.0 / 50.0;
+
+        if (options.hash && !sys->gpu->isFrameSkipped()) fmt::print("frame {} {:016x}\n", frames, displayHash(sys->gpu.get()));
     }
 
-    return 0;
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (sys->state != System::State::run) {
+        fmt::print("Emulation stopped ({}) at frame {}\n", magic_enum::enum_name(sys->state), frames);
+    }
+    report(sys.get(), frames, emulatedSeconds, hostSeconds);
+    return sys->state == System::State::run ? 0 : 1;
 }
@@ -3,6 +3,7 @@
 namespace Sound {
 std::deque<uint16_t> buffer;
 std::mutex audioMutex;
+TimeStretch timeStretch;
 }  // namespace Sound
 
 void Sound::init() {}
@@ -12,3 +13,8 @@ void Sound::play() {}
 void Sound::stop() {}
 
 void Sound::close() {}
+
+void Sound::clearBuffer() {
+    buffer.clear();
+    timeStretch.reset();
+}
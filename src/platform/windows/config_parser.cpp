@@ -2,6 +2,7 @@
 #include <nlohmann/json.hpp>
 #include <fmt/core.h>
 #include "config.h"
+#include "cpu/cpu_mode.h"
 #include "device/controller/controller_type.h"
 #include "device/gpu/rendering_mode.h"
 #include "utils/file.h"
@@ -15,6 +16,7 @@ const char* CONFIG_NAME = "config.json";
 std::string configPath() { return avocado::PATH_USER + CONFIG_NAME; }
 
 JSON_ENUM(ControllerType);
+JSON_ENUM(CpuMode);
 JSON_ENUM(RenderingMode);
 
 void saveConfigFile() {
@@ -46,6 +48,9 @@ void saveConfigFile() {
         },
         {"vsync", g.vsync},
         {"forceNtsc", g.forceNtsc},
+        {"frameSkip", g.frameSkip},
+        {"rendererThreads", g.rendererThreads},
+        {"gpuThread", g.gpuThread},
     };
 
     json["options"]["sound"] = {
@@ -55,6 +60,16 @@ void saveConfigFile() {
     json["options"]["emulator"] = {
         {"preserveState", config.options.emulator.preserveState},
         {"timeTravel", config.options.emulator.timeTravel},
+        {"cpuMode", config.options.emulator.cpuMode},
+        {"fastmem", config.options.emulator.fastmem},
+        {"hle", config.options.emulator.hle},
+        {
+            "turbo",
+            {
+                {"speed", config.options.emulator.turbo.speed},
+                {"frameSkip", config.options.emulator.turbo.frameSkip},
+            },
+        },
     };
 
     auto l = config.debug.log;
@@ -116,6 +131,9 @@ void loadConfigFile() {
             config.options.graphics.resolution.height = g["resolution"]["height"];
             config.options.graphics.vsync = g["vsync"];
             config.options.graphics.forceNtsc = g["forceNtsc"];
+            config.options.graphics.frameSkip = g.value("frameSkip", config.options.graphics.frameSkip);
+            config.options.graphics.rendererThreads = g.value("rendererThreads", config.options.graphics.rendererThreads);
+            config.options.graphics.gpuThread = g.value("gpuThread", config.options.graphics.gpuThread);
         }
 
         if (auto s = json["options"]["sound"]; !s.is_null()) {
@@ -125,6 +143,15 @@ void loadConfigFile() {
         if (auto e = json["options"]["emulator"]; !e.is_null()) {
             config.options.emulator.preserveState = e["preserveState"];
             config.options.emulator.timeTravel = e["timeTravel"];
+            config.options.emulator.cpuMode = e.value("cpuMode", config.options.emulator.cpuMode);
+            config.options.emulator.fastmem = e.value("fastmem", config.options.emulator.fastmem);
+            if (auto h = e["hle"]; !h.is_null()) {
+                config.options.emulator.hle = h.get<std::unordered_map<std::string, bool>>();
+            }
+            if (auto t = e["turbo"]; !t.is_null()) {
+                config.options.emulator.turbo.speed = t["speed"];
+                config.options.emulator.turbo.frameSkip = t["frameSkip"];
+            }
         }
 
         if (auto l = json["debug"]["log"]; !l.is_null()) {
@@ -0,0 +1,118 @@
+#include "emulation_thread.h"
+#include <SDL.h>
+#include <algorithm>
+#include "sound/sound.h"
+#include "state/state.h"
+#include "system.h"
+
+namespace {
+// Warning: this method might have 1 or more milliseconds of inaccuracy.
+double limitFramerate(int speed, bool ntsc) {
+    static double timeToSkip = 0;
+    static double counterFrequency = (double)SDL_GetPerformanceFrequency();
+    static double startTime = SDL_GetPerformanceCounter() / counterFrequency;
+    static double fpsTime = 0.0;
+    static double fps = 0;
+    static int deltaFrames = 0;
+
+    double currentTime = SDL_GetPerformanceCounter() / counterFrequency;
+    double deltaTime = currentTime - startTime;
+
+    double frameTime = (ntsc ? (1.0 / 60.0) : (1.0 / 50.0)) / std::max(speed, 1);
+
+    if (speed != 0 && deltaTime < frameTime) {
+        // If deltaTime was shorter than frameTime - spin
+        if (deltaTime < frameTime - timeToSkip) {
+            while (deltaTime < frameTime - timeToSkip) {  // calculate real difference
+                SDL_Delay(1);
+
+                currentTime = SDL_GetPerformanceCounter() / counterFrequency;
+                deltaTime = currentTime - startTime;
+            }
+            timeToSkip -= (frameTime - deltaTime);
+            if (timeToSkip < 0.0) timeToSkip = 0.0;
+        } else {  // Else - accumulate
+            timeToSkip += deltaTime - frameTime;
+        }
+    }
+
+    startTime = currentTime;
+    fpsTime += deltaTime;
+    deltaFrames++;
+
+    if (fpsTime > 0.25f) {
+        fps = (double)deltaFrames / fpsTime;
+        deltaFrames = 0;
+        fpsTime = 0.0;
+    }
+
+    return fps;
+}
+}  // namespace
+
+EmulationThread::Access::Access(EmulationThread& emulation) : emulation(emulation) {
+    emulation.frontendWaiting = true;
+    lock = std::unique_lock<std::mutex>(emulation.mutex);
+    emulation.frontendWaiting = false;
+
+    // GPU thread might still execute commands submitted during the frame (writes VRAM and GPU log)
+    if (emulation.sys) emulation.sys->gpu->synchronize();
+}
+
+EmulationThread::Access::~Access() {
+    lock.unlock();
+    emulation.wake.notify_one();
+}
+
+EmulationThread::EmulationThread(std::unique_ptr<System>& sys) : sys(sys), frames(std::make_unique<TripleBuffer<gpu::Frame>>()) {
+    thread = std::thread(&EmulationThread::run, this);
+}
+
+EmulationThread::~EmulationThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exitRequested = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void EmulationThread::run() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        // Frontend waiting for Access goes first, frame can't starve it
+        wake.wait(lock, [this] { return exitRequested || (!frontendWaiting && sys->state == System::State::run); });
+        if (exitRequested) break;
+
+        sys->gpu->clear();
+        sys->controller->update();
+
+        sys->emulateFrame();
+        if (singleFrame) {
+            singleFrame = false;
+            sys->state = System::State::pause;
+        }
+
+        state::manageTimeTravel(sys.get());
+        if (!sys->gpu->isFrameSkipped()) publishFrame();
+
+        bool ntsc = sys->gpu->isNtsc();
+        lock.unlock();
+
+        int speed = this->speed;
+        fps = limitFramerate(speed, ntsc);
+
+        // Audio produced faster than real time is time-stretched to measured speed
+        Sound::setSpeed(speed == 1 ? 1.0 : std::max(1.0, fps / (ntsc ? 60.0 : 50.0)));
+    }
+}
+
+void EmulationThread::publishFrame() {
+    sys->gpu->captureFrame(frames->writeBuffer());
+    frames->publish();
+}
+
+const gpu::Frame* EmulationThread::latestFrame() {
+    frames->update();
+    return &frames->readBuffer();
+}
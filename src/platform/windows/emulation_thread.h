@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "device/gpu/gpu.h"
+#include "utils/triple_buffer.h"
+
+struct System;
+
+/*
+Runs emulation on its own thread, so presentation (GL driver, vsync, ImGui) doesn't stall it.
+Finished frames are handed to render thread through lock-free triple buffer,
+input arrives through InputManager update queue.
+Frontend code touching System has to hold Access - emulation is suspended between frames meanwhile.
+*/
+class EmulationThread {
+    std::unique_ptr<System>& sys;
+
+    std::mutex mutex;  // Held by emulation for the duration of a frame
+    std::condition_variable wake;
+    std::atomic<bool> frontendWaiting{false};
+    std::atomic<bool> exitRequested{false};
+    std::unique_ptr<TripleBuffer<gpu::Frame>> frames;
+    std::thread thread;
+
+    void run();
+
+   public:
+    // Exclusive access to System for frontend
+    class Access {
+        EmulationThread& emulation;
+        std::unique_lock<std::mutex> lock;
+
+       public:
+        explicit Access(EmulationThread& emulation);
+        ~Access();
+    };
+
+    std::atomic<int> speed{1};  // Multiplier of real time speed, 0 - unlimited
+    std::atomic<bool> singleFrame{false};  // Pause after next frame
+    std::atomic<double> fps{0.0};
+
+    explicit EmulationThread(std::unique_ptr<System>& sys);
+    ~EmulationThread();
+
+    // Must be called with Access held (or from emulation thread)
+    void publishFrame();
+    bool hasNewFrame() const { return frames->hasUpdate(); }
+    // Newest published frame
+    const gpu::Frame* latestFrame();
+};
@@ -482,7 +482,7 @@ void GPU::logWindow(System *sys) {
     ImGui::PopItemWidth();
     ImGui::SameLine();
     if (ImGui::Button("Capture")) {
-        GpuDrawList::framesToCapture = framesToCapture;
+        sys->framesToCapture = framesToCapture;
         sys->state = System::State::run;
     }
 
@@ -562,6 +562,7 @@ void GPU::vramWindow(gpu::GPU *gpu) {
 }
 
 void GPU::displayWindows(System *sys) {
+    sys->gpu->gpuLogEnabled = logWindowOpen;
     if (registersWindowOpen) registersWindow(sys);
     if (logWindowOpen) logWindow(sys);
     if (vramWindowOpen) vramWindow(sys->gpu.get());
@@ -235,6 +235,38 @@ void GUI::mainMenu(std::unique_ptr<System>& sys) {
             config.options.emulator.timeTravel = timeTravel;
         }
 
+        if (ImGui::BeginMenu("CPU")) {
+            auto cpuModeItem = [](const char* name, CpuMode mode) {
+                if (ImGui::MenuItem(name, nullptr, config.options.emulator.cpuMode == mode)) {
+                    config.options.emulator.cpuMode = mode;
+                    bus.notify(Event::Config::Cpu{});
+                }
+            };
+            cpuModeItem("Interpreter", CpuMode::interpreter);
+            cpuModeItem("Cached interpreter", CpuMode::cachedInterpreter);
+            cpuModeItem("Threaded interpreter", CpuMode::threadedInterpreter);
+            cpuModeItem("Recompiler (x86-64)", CpuMode::jit);
+            ImGui::Separator();
+
+            bool fastmem = config.options.emulator.fastmem;
+            if (ImGui::MenuItem("Fastmem", nullptr, &fastmem)) {
+                config.options.emulator.fastmem = fastmem;
+                bus.notify(Event::Config::Cpu{});
+            }
+
+            if (ImGui::BeginMenu("Native BIOS functions")) {
+                for (const auto& option : bios::hle::options()) {
+                    bool enabled = config.options.emulator.hle[option];
+                    if (ImGui::MenuItem(option.c_str(), nullptr, &enabled)) {
+                        config.options.emulator.hle[option] = enabled;
+                        bus.notify(Event::Config::Cpu{});
+                    }
+                }
+                ImGui::EndMenu();
+            }
+            ImGui::EndMenu();
+        }
+
         ImGui::EndMenu();
     }
     if (ImGui::BeginMenu("Help")) {
@@ -250,8 +282,10 @@ void GUI::mainMenu(std::unique_ptr<System>& sys) {
         info += " | Paused";
     } else {
         info += fmt::format(" | {:.0f} FPS", statusFps);
-        if (!statusFramelimitter) {
+        if (statusSpeed == 0) {
             info += " (Unlimited)";
+        } else if (statusSpeed != 1) {
+            info += fmt::format(" (Turbo {}x)", statusSpeed);
         }
     }
     auto size = ImGui::CalcTextSize(info.c_str());
@@ -266,7 +300,7 @@ void GUI::mainMenu(std::unique_ptr<System>& sys) {
     ImGui::EndMainMenuBar();
 }
 
-void GUI::render(std::unique_ptr<System>& sys) {
+void GUI::newFrame(std::unique_ptr<System>& sys) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(window);
     ImGui::NewFrame();
@@ -332,7 +366,9 @@ void GUI::render(std::unique_ptr<System>& sys) {
 
     // Work in progress
     //    renderController();
+}
 
+void GUI::render() {
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
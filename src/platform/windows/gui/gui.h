@@ -55,7 +55,7 @@ class GUI {
 
     // Status
     double statusFps = 0.0;
-    bool statusFramelimitter = true;
+    int statusSpeed = 1;  // Multiplier of real time, 0 - unlimited
     bool statusMouseLocked = false;
 
     // Drag&drop
@@ -66,5 +66,8 @@ class GUI {
     ~GUI();
 
     void processEvent(SDL_Event* e);
-    void render(std::unique_ptr<System>& sys);
+    // Builds windows from System state, emulation has to be suspended
+    void newFrame(std::unique_ptr<System>& sys);
+    // Draws built frame, doesn't touch System
+    void render();
 };
\ No newline at end of file
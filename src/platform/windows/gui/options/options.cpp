@@ -405,6 +405,7 @@ void hotkeysSetupWindow() {
     button("toggle_pause", "Pause");
     button("reset", "Reset");
     button("toggle_framelimit", "Toggle framelimit");
+    button("toggle_turbo", "Toggle turbo");
     button("close_tray", "Close disk tray");
     button("single_frame", "Single frame");
     button("single_step", "Single step");
@@ -91,7 +91,7 @@ bool SdlInputManager::handleKey(Key key, AnalogValue value) {
 
             if (Key(keyName) == key) {
                 auto path = fmt::format("controller/{}/{}", c, button);
-                state[path.c_str()] = value;
+                setState(path, value);
                 result = true;
             }
         }
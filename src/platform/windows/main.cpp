@@ -8,6 +8,7 @@
 #include "config.h"
 #include "config_parser.h"
 #include "disc/load.h"
+#include "emulation_thread.h"
 #include "gui/filesystem.h"
 #include "gui/gui.h"
 #include "input/sdl_input_manager.h"
@@ -29,49 +30,6 @@
 
 #undef main
 
-// Warning: this method might have 1 or more milliseconds of inaccuracy.
-double limitFramerate(bool framelimiter, bool ntsc) {
-    static double timeToSkip = 0;
-    static double counterFrequency = (double)SDL_GetPerformanceFrequency();
-    static double startTime = SDL_GetPerformanceCounter() / counterFrequency;
-    static double fpsTime = 0.0;
-    static double fps = 0;
-    static int deltaFrames = 0;
-
-    double currentTime = SDL_GetPerformanceCounter() / counterFrequency;
-    double deltaTime = currentTime - startTime;
-
-    double frameTime = ntsc ? (1.0 / 60.0) : (1.0 / 50.0);
-
-    if (framelimiter && deltaTime < frameTime) {
-        // If deltaTime was shorter than frameTime - spin
-        if (deltaTime < frameTime - timeToSkip) {
-            while (deltaTime < frameTime - timeToSkip) {  // calculate real difference
-                SDL_Delay(1);
-
-                currentTime = SDL_GetPerformanceCounter() / counterFrequency;
-                deltaTime = currentTime - startTime;
-            }
-            timeToSkip -= (frameTime - deltaTime);
-            if (timeToSkip < 0.0) timeToSkip = 0.0;
-        } else {  // Else - accumulate
-            timeToSkip += deltaTime - frameTime;
-        }
-    }
-
-    startTime = currentTime;
-    fpsTime += deltaTime;
-    deltaFrames++;
-
-    if (fpsTime > 0.25f) {
-        fps = (double)deltaFrames / fpsTime;
-        deltaFrames = 0;
-        fpsTime = 0.0;
-    }
-
-    return fps;
-}
-
 void fatalError(const std::string& error) {
     fmt::print(stderr, "[FATAL] {}", error);
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Avocado", error.c_str(), nullptr);
@@ -195,10 +153,23 @@ int main(int argc, char** argv) {
 
     auto gui = std::make_unique<GUI>(window, glContext);
     Sound::init();
+    // Passed to every System frontend creates, batch instances have no audio output
+    auto audioOutput = std::make_shared<Sound::Output>();
+
+    // Core posts events on System bus, GUI uses global one - frontend passes them between both
+    auto systemBus = std::make_shared<Dexode::EventBus>();
+    int systemBusToken = systemBus->listen<Event::Gui::Toast>([&](auto e) { bus.notify(e); });
+    systemBus->listen<Event::Gui::Debug::OpenDrawListWindows>(systemBusToken, [&](auto e) { bus.notify(e); });
+    systemBus->listen<Event::Controller::Vibration>(systemBusToken, [&](auto e) { bus.notify(e); });
 
-    std::unique_ptr<System> sys = system_tools::hardReset();
+    std::unique_ptr<System> sys = system_tools::hardReset(config, systemBus, audioOutput);
+
+    bool turboEnabled = false;
+    // Turbo replaces frame skip set in options, reapplied whenever System or its GPU options are recreated
+    bool frameSkipChanged = true;
 
     int busToken = bus.listen<Event::File::Load>([&](auto e) {
+        frameSkipChanged = true;  // Booting replaces System
         if (disc::isDiscImage(e.file)) {
             if (e.action == Event::File::Load::Action::ask) {
                 // Show dialog and decide what to do
@@ -252,7 +223,10 @@ int main(int argc, char** argv) {
     bool exitProgram = false;
     bus.listen<Event::File::Exit>(busToken, [&](auto) { exitProgram = true; });
     bus.listen<Event::System::SoftReset>(busToken, [&](auto) { sys->softReset(); });
-    bus.listen<Event::System::HardReset>(busToken, [&](auto) { sys = system_tools::hardReset(); });
+    bus.listen<Event::System::HardReset>(busToken, [&](auto) {
+        sys = system_tools::hardReset(config, systemBus, audioOutput);
+        frameSkipChanged = true;
+    });
     bus.listen<Event::System::SaveState>(busToken, [&](auto e) { state::quickSave(sys.get(), e.slot); });
     bus.listen<Event::System::LoadState>(busToken, [&](auto e) { state::quickLoad(sys.get(), e.slot); });
 
@@ -273,6 +247,28 @@ int main(int argc, char** argv) {
         }
     });
 
+    // Options changed in GUI are applied to System before its devices reload
+    bus.listen<Event::Config::Graphics>(busToken, [&](auto e) {
+        sys->config = config;
+        systemBus->notify(e);
+        frameSkipChanged = true;
+    });
+    bus.listen<Event::Config::Gte>(busToken, [&](auto e) {
+        sys->config = config;
+        systemBus->notify(e);
+    });
+    bus.listen<Event::Config::Controller>(busToken, [&](auto e) {
+        sys->config = config;
+        systemBus->notify(e);
+    });
+
+    bus.listen<Event::Config::Cpu>(busToken, [&](auto) {
+        sys->config = config;
+        sys->cpu->setMode(config.options.emulator.cpuMode);
+        sys->setFastmem(config.options.emulator.fastmem);
+        sys->setHle(config.options.emulator.hle);
+    });
+
     if (config.options.sound.enabled) {
         Sound::play();
     }
@@ -304,131 +300,154 @@ int main(int argc, char** argv) {
     bool frameLimitEnabled = true;
     bool forceRedraw = false;
 
+    bool emulationRunning = sys->state == System::State::run;  // As of previous iteration, updated under Access
+    auto emulation = std::make_unique<EmulationThread>(sys);
+
     SDL_Event event;
     while (running && !exitProgram) {
         bool newEvent = false;
-        if (!forceRedraw && sys->state != System::State::run) {
+        if (!forceRedraw && !emulationRunning) {
             if (SDL_WaitEventTimeout(&event, 1000)) {
                 newEvent = true;
             }
+        } else if (!forceRedraw) {
+            // Wait for next emulated frame instead of spinning (with VSync disabled), GUI keeps being redrawn
+            for (int ms = 0; ms < 20 && !emulation->hasNewFrame(); ms++) SDL_Delay(1);
         }
         forceRedraw = false;
 
-        auto lockMouse = sys->state == System::State::run && inputManager->mouseLocked;
-        SDL_SetRelativeMouseMode((SDL_bool)lockMouse);
-
-        inputManager->newFrame();
-        while (newEvent || SDL_PollEvent(&event)) {
-            gui->processEvent(&event);
-
-            inputManager->keyboardCaptured = ImGui::GetIO().WantCaptureKeyboard;
-            inputManager->mouseCaptured = ImGui::GetIO().WantCaptureMouse;
-
-            newEvent = false;
-            if (inputManager->handleEvent(event)) continue;
-            if (event.type == SDL_QUIT || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE)) running = false;
-
-            Key button = Key();
-            if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
-                button = Key::keyboard(event.key.keysym.sym);
-            } else if (event.type == SDL_CONTROLLERBUTTONDOWN) {
-                button = Key::controllerButton(event.cbutton);
-            } else if (event.type == SDL_CONTROLLERAXISMOTION) {
-                if (std::abs(event.caxis.value) == 32767) button = Key::controllerMove(event.caxis);
-            }
+        {
+            // Emulation is suspended while events modify System and GUI reads it - once per presented frame
+            EmulationThread::Access access(*emulation);
+            auto lockMouse = sys->state == System::State::run && inputManager->mouseLocked;
+            SDL_SetRelativeMouseMode((SDL_bool)lockMouse);
+
+            inputManager->newFrame();
+            while (newEvent || SDL_PollEvent(&event)) {
+                gui->processEvent(&event);
+
+                inputManager->keyboardCaptured = ImGui::GetIO().WantCaptureKeyboard;
+                inputManager->mouseCaptured = ImGui::GetIO().WantCaptureMouse;
+
+                newEvent = false;
+                if (inputManager->handleEvent(event)) continue;
+                if (event.type == SDL_QUIT || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE))
+                    running = false;
+
+                Key button = Key();
+                if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
+                    button = Key::keyboard(event.key.keysym.sym);
+                } else if (event.type == SDL_CONTROLLERBUTTONDOWN) {
+                    button = Key::controllerButton(event.cbutton);
+                } else if (event.type == SDL_CONTROLLERAXISMOTION) {
+                    if (std::abs(event.caxis.value) == 32767) button = Key::controllerMove(event.caxis);
+                }
 
-            if (!inputManager->keyboardCaptured && button.type != Key::Type::None) {
-                if (event.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (event.key.keysym.sym == SDLK_AC_BACK) running = false;
-                if (button == Key(config.hotkeys["toggle_menu"])) gui->showMenu = !gui->showMenu;
-                if (button == Key(config.hotkeys["reset"])) {
-                    if (event.key.keysym.mod & KMOD_SHIFT) {
-                        sys = system_tools::hardReset();
-                        toast("Hard reset");
-                    } else {
-                        sys->softReset();
-                        toast("Soft reset");
+                if (!inputManager->keyboardCaptured && button.type != Key::Type::None) {
+                    if (event.key.keysym.sym == SDLK_ESCAPE) running = false;
+                    if (event.key.keysym.sym == SDLK_AC_BACK) running = false;
+                    if (button == Key(config.hotkeys["toggle_menu"])) gui->showMenu = !gui->showMenu;
+                    if (button == Key(config.hotkeys["reset"])) {
+                        if (event.key.keysym.mod & KMOD_SHIFT) {
+                            sys = system_tools::hardReset(config, systemBus, audioOutput);
+                            frameSkipChanged = true;
+                            toast("Hard reset");
+                        } else {
+                            sys->softReset();
+                            toast("Soft reset");
+                        }
                     }
-                }
-                if (button == Key(config.hotkeys["close_tray"])) {
-                    sys->cdrom->toggleShell();
-                    toast(fmt::format("Shell {}", sys->cdrom->getShell() ? "open" : "closed"));
-                }
-                if (button == Key(config.hotkeys["quick_save"])) {
-                    bus.notify(Event::System::SaveState{});
-                }
-                if (button == Key(config.hotkeys["single_frame"])) {
-                    gui->singleFrame = true;
-                    sys->state = System::State::run;
-                }
-                if (button == Key(config.hotkeys["quick_load"])) {
-                    bus.notify(Event::System::LoadState{});
-                }
-                if (button == Key(config.hotkeys["single_step"])) {
-                    sys->singleStep();
-                }
-                if (button == Key(config.hotkeys["toggle_pause"])) {
-                    if (sys->state == System::State::pause) {
+                    if (button == Key(config.hotkeys["close_tray"])) {
+                        sys->cdrom->toggleShell();
+                        toast(fmt::format("Shell {}", sys->cdrom->getShell() ? "open" : "closed"));
+                    }
+                    if (button == Key(config.hotkeys["quick_save"])) {
+                        bus.notify(Event::System::SaveState{});
+                    }
+                    if (button == Key(config.hotkeys["single_frame"])) {
+                        gui->singleFrame = true;
                         sys->state = System::State::run;
-                    } else if (sys->state == System::State::run) {
-                        sys->state = System::State::pause;
                     }
-                    toast(fmt::format("Emulation {}", sys->state == System::State::run ? "resumed" : "paused"));
-                }
-                if (button == Key(config.hotkeys["toggle_framelimit"])) {
-                    frameLimitEnabled = !frameLimitEnabled;
-                    toast(fmt::format("Frame limiter {}", frameLimitEnabled ? "enabled" : "disabled"));
-                }
-                if (button == Key(config.hotkeys["rewind_state"])) {
-                    if (state::rewindState(sys.get())) {
-                        toast("Going back 1 second");
+                    if (button == Key(config.hotkeys["quick_load"])) {
+                        bus.notify(Event::System::LoadState{});
+                    }
+                    if (button == Key(config.hotkeys["single_step"])) {
+                        sys->singleStep();
+                    }
+                    if (button == Key(config.hotkeys["toggle_pause"])) {
+                        if (sys->state == System::State::pause) {
+                            sys->state = System::State::run;
+                        } else if (sys->state == System::State::run) {
+                            sys->state = System::State::pause;
+                        }
+                        toast(fmt::format("Emulation {}", sys->state == System::State::run ? "resumed" : "paused"));
+                    }
+                    if (button == Key(config.hotkeys["toggle_framelimit"])) {
+                        frameLimitEnabled = !frameLimitEnabled;
+                        toast(fmt::format("Frame limiter {}", frameLimitEnabled ? "enabled" : "disabled"));
+                    }
+                    if (button == Key(config.hotkeys["toggle_turbo"])) {
+                        turboEnabled = !turboEnabled;
+                        frameSkipChanged = true;
+                        auto speed = config.options.emulator.turbo.speed;
+                        toast(!turboEnabled ? "Turbo disabled" : (speed == 0 ? "Turbo (unlimited)" : fmt::format("Turbo {}x", speed)));
+                    }
+                    if (button == Key(config.hotkeys["rewind_state"])) {
+                        if (state::rewindState(sys.get())) {
+                            toast("Going back 1 second");
+                        }
+                    }
+                    if (button == Key(config.hotkeys["toggle_fullscreen"])) {
+                        bus.notify(Event::Gui::ToggleFullscreen{});
                     }
                 }
-                if (button == Key(config.hotkeys["toggle_fullscreen"])) {
-                    bus.notify(Event::Gui::ToggleFullscreen{});
+                if (event.type == SDL_DROPFILE) {
+                    std::string path = event.drop.file;
+                    SDL_free(event.drop.file);
+
+                    bus.notify(Event::File::Load{path});
+                }
+                if (event.type == SDL_WINDOWEVENT
+                    && (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED || event.window.event == SDL_WINDOWEVENT_RESIZED)) {
+                    opengl->width = event.window.data1;
+                    opengl->height = event.window.data2;
                 }
-            }
-            if (event.type == SDL_DROPFILE) {
-                std::string path = event.drop.file;
-                SDL_free(event.drop.file);
 
-                bus.notify(Event::File::Load{path});
-            }
-            if (event.type == SDL_WINDOWEVENT
-                && (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED || event.window.event == SDL_WINDOWEVENT_RESIZED)) {
-                opengl->width = event.window.data1;
-                opengl->height = event.window.data2;
+                // Crude hack to force next frame after last event received (in paused mode)
+                // Fixes ImGui window drawing
+                forceRedraw = true;
             }
 
-            // Crude hack to force next frame after last event received (in paused mode)
-            // Fixes ImGui window drawing
-            forceRedraw = true;
-        }
+            emulation->speed = !frameLimitEnabled ? 0 : (turboEnabled ? config.options.emulator.turbo.speed : 1);
+            if (frameSkipChanged) {
+                frameSkipChanged = false;
+                sys->gpu->setFrameSkip(turboEnabled ? config.options.emulator.turbo.frameSkip : config.options.graphics.frameSkip);
+            }
+            // Stopped emulation doesn't produce frames, changes made by frontend (state load, reset) are shown directly
+            if (sys->state != System::State::run) emulation->publishFrame();
 
-        if (sys->state == System::State::run) {
-            sys->gpu->clear();
-            sys->controller->update();
+            gui->statusSpeed = emulation->speed;
+            gui->statusMouseLocked = inputManager->mouseLocked;
+            gui->statusFps = emulation->fps;
+            gui->newFrame(sys);
+            sys->config = config;  // Options without reload event (time travel, memory cards) apply directly
 
-            sys->emulateFrame();
             if (gui->singleFrame) {
                 gui->singleFrame = false;
-                sys->state = System::State::pause;
+                emulation->singleFrame = true;
             }
-
-            state::manageTimeTravel(sys.get());
+            emulationRunning = sys->state == System::State::run;
         }
 
+        // Presentation (GL driver, vsync) runs in parallel with emulation
         SDL_GL_GetDrawableSize(window, &opengl->width, &opengl->height);
-        opengl->render(sys->gpu.get());
-
-        gui->statusFramelimitter = frameLimitEnabled;
-        gui->statusMouseLocked = inputManager->mouseLocked;
-        gui->render(sys);
+        opengl->render(emulation->latestFrame());
+        gui->render();
 
         SDL_GL_SwapWindow(window);
-
-        gui->statusFps = limitFramerate(frameLimitEnabled, sys->gpu->isNtsc());
     }
+    emulation.reset();
+
     if (config.options.emulator.preserveState && sys->state != System::State::halted) {
         state::saveLastState(sys.get());
     }
@@ -436,6 +455,7 @@ int main(int argc, char** argv) {
     saveConfigFile();
 
     bus.unlistenAll(busToken);
+    systemBus->unlistenAll(systemBusToken);
     Sound::close();
     InputManager::setInstance(nullptr);
     SDL_GL_DeleteContext(glContext);
@@ -5,6 +5,7 @@
 namespace Sound {
 std::deque<uint16_t> buffer;
 std::mutex audioMutex;
+TimeStretch timeStretch;
 };  // namespace Sound
 
 namespace {
@@ -56,4 +57,8 @@ void Sound::stop() { SDL_PauseAudioDevice(dev, true); }
 
 void Sound::close() { SDL_CloseAudioDevice(dev); }
 
-void Sound::clearBuffer() { buffer.clear(); }
+void Sound::clearBuffer() {
+    std::unique_lock<std::mutex> lock(audioMutex);
+    buffer.clear();
+    timeStretch.reset();
+}
@@ -184,7 +184,7 @@ void OpenGL::bindCopyAttributes() {
     copyShader->getAttrib("texcoord").pointer(2, GL_FLOAT, sizeof(BlitStruct), 2 * sizeof(float));
 }
 
-void OpenGL::update24bitTexture(gpu::GPU* gpu) {
+void OpenGL::update24bitTexture(const gpu::Frame* frame) {
     size_t dataSize = gpu::VRAM_HEIGHT * gpu::VRAM_WIDTH * 3;
     if (vram24Unpacked.size() != dataSize) {
         vram24Unpacked.resize(dataSize);
@@ -195,9 +195,9 @@ void OpenGL::update24bitTexture(gpu::GPU* gpu) {
         unsigned int gpuOffset = y * gpu::VRAM_WIDTH;
         unsigned int texOffset = y * gpu::VRAM_WIDTH * 3;
         for (int x = 0; x < gpu::VRAM_WIDTH; x += 3) {
-            uint16_t c1 = gpu->vram[gpuOffset + 0];
-            uint16_t c2 = gpu->vram[gpuOffset + 1];
-            uint16_t c3 = gpu->vram[gpuOffset + 2];
+            uint16_t c1 = frame->vram[gpuOffset + 0];
+            uint16_t c2 = frame->vram[gpuOffset + 1];
+            uint16_t c3 = frame->vram[gpuOffset + 2];
 
             uint8_t r0 = (c1 & 0x00ff) >> 0;
             uint8_t g0 = (c1 & 0xff00) >> 8;
@@ -220,9 +220,9 @@ void OpenGL::update24bitTexture(gpu::GPU* gpu) {
     vram24Tex->update(vram24Unpacked.data());
 }
 
-void OpenGL::updateVramTexture(gpu::GPU* gpu) {
+void OpenGL::updateVramTexture(const gpu::Frame* frame) {
     if (supportNativeTexture) {
-        vramTex->update(gpu->vram.data());
+        vramTex->update(frame->vram.data());
         return;
     }
 
@@ -236,23 +236,23 @@ void OpenGL::updateVramTexture(gpu::GPU* gpu) {
         for (int x = 0; x < gpu::VRAM_WIDTH; x++) {
             unsigned int pos = y * gpu::VRAM_WIDTH + x;
 
-            vramUnpacked[pos] = PSXColor(gpu->vram[pos]).rev();
+            vramUnpacked[pos] = PSXColor(frame->vram[pos]).rev();
         }
     }
     vramTex->update(vramUnpacked.data());
 }
 
-void OpenGL::renderVertices(gpu::GPU* gpu) {
+void OpenGL::renderVertices(const gpu::Frame* frame) {
     static vec2 lastPos;
-    auto& buffer = gpu->vertices;
+    auto& buffer = frame->vertices;
     if (buffer.empty()) {
         return;
     }
 
     int areaX = static_cast<int>(lastPos.x);
     int areaY = static_cast<int>(lastPos.y);
-    int areaW = static_cast<int>(gpu->gp1_08.getHorizontalResoulution());
-    int areaH = static_cast<int>(gpu->gp1_08.getVerticalResoulution());
+    int areaW = static_cast<int>(frame->gp1_08.getHorizontalResoulution());
+    int areaH = static_cast<int>(frame->gp1_08.getVerticalResoulution());
 
     // Simulate GPU in Shader (skip if no entries in renderlist)
     glViewport(0, 0, renderWidth, renderHeight);
@@ -315,14 +315,14 @@ void OpenGL::renderVertices(gpu::GPU* gpu) {
 
         glDrawArrays(GL_TRIANGLES, i, count);
     }
-    lastPos = vec2(gpu->displayAreaStartX, gpu->displayAreaStartY);
+    lastPos = vec2(frame->displayAreaStartX, frame->displayAreaStartY);
 
     glBlendColor(1.f, 1.f, 1.f, 1.f);
     glDisable(GL_BLEND);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
+void OpenGL::renderBlit(const gpu::Frame* frame, bool software) {
     blitShader->use();
 
     // Viewport settings
@@ -335,8 +335,8 @@ void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
 
     std::vector<BlitStruct> bb = makeBlitBuf(0, 0, 1024, 512);
     if (software) {
-        bb = makeBlitBuf(gpu->displayAreaStartX, gpu->displayAreaStartY, gpu->gp1_08.getHorizontalResoulution(),
-                         gpu->gp1_08.getVerticalResoulution(), true);
+        bb = makeBlitBuf(frame->displayAreaStartX, frame->displayAreaStartY, frame->gp1_08.getHorizontalResoulution(),
+                         frame->gp1_08.getVerticalResoulution(), true);
     }
 
     if (width > height * aspect) {
@@ -353,22 +353,22 @@ void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
         float yOffset = y / static_cast<float>(h);  // Compensate for aspect ratio
         float xOffset = x / static_cast<float>(w);  // TODO: Handle 24bit mode!
 
-        float vResolution = gpu->isNtsc() ? 240 : 256;
+        float vResolution = frame->isNtsc() ? 240 : 256;
 
         float displayTop = 0.f;
-        float displayBottom = (gpu->displayRangeY2 - gpu->displayRangeY1) / vResolution;
+        float displayBottom = (frame->displayRangeY2 - frame->displayRangeY1) / vResolution;
 
         // V aligment disabled for now
-        // int firstLine = gpu->isNtsc() ? (0x88 - 224/2)  : (0xA3 - 264/2);
-        // y -= ((gpu->displayRangeY1 - firstLine) / vResolution) * h;
+        // int firstLine = frame->isNtsc() ? (0x88 - 224/2)  : (0xA3 - 264/2);
+        // y -= ((frame->displayRangeY1 - firstLine) / vResolution) * h;
 
-        float hres = gpu->gp1_08.getHorizontalResoulution();
+        float hres = frame->gp1_08.getHorizontalResoulution();
         int cyclesPerPixel = ceilf(640 * 4 / hres);
 
-        float displayXOffset = (gpu->displayRangeX1 - 0x260) / cyclesPerPixel / hres;
+        float displayXOffset = (frame->displayRangeX1 - 0x260) / cyclesPerPixel / hres;
 
         float displayLeft = 0.f;
-        float displayRight = (gpu->displayRangeX2 - gpu->displayRangeX1) / cyclesPerPixel / hres;
+        float displayRight = (frame->displayRangeX2 - frame->displayRangeX1) / cyclesPerPixel / hres;
 
         // Move display to right by offset
         x += displayXOffset * w;
@@ -378,7 +378,7 @@ void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
         blitShader->getUniform("displayVertical").f(displayTop - yOffset, displayBottom - yOffset);
     }
 
-    blitShader->getUniform("displayEnabled").i(!gpu->displayDisable);
+    blitShader->getUniform("displayEnabled").i(!frame->displayDisable);
 
     glViewport(x, y, w, h);
     blitBuffer->update(bb.size() * sizeof(BlitStruct), bb.data());
@@ -387,7 +387,7 @@ void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
     bindBlitAttributes();
 
     // Hack
-    if (gpu->gp1_08.colorDepth == gpu::GP1_08::ColorDepth::bit24) {
+    if (frame->gp1_08.colorDepth == gpu::GP1_08::ColorDepth::bit24) {
         vram24Tex->bind(0);
     } else if (software) {
         vramTex->bind(0);
@@ -400,27 +400,27 @@ void OpenGL::renderBlit(gpu::GPU* gpu, bool software) {
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
-void OpenGL::render(gpu::GPU* gpu) {
+void OpenGL::render(const gpu::Frame* frame) {
     vao->bind();
     // Clear framebuffer
     glClearColor(0.f, 0.f, 0.f, 1.f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    if (gpu->gp1_08.colorDepth == gpu::GP1_08::ColorDepth::bit24) {
+    if (frame->gp1_08.colorDepth == gpu::GP1_08::ColorDepth::bit24) {
         // HACK: Force software rendering for movies (24bit mode)
-        update24bitTexture(gpu);
-        renderBlit(gpu, true);
+        update24bitTexture(frame);
+        renderBlit(frame, true);
     } else {
-        updateVramTexture(gpu);
+        updateVramTexture(frame);
 
         if (hardwareRendering) {
             // Render all GPU commands
-            renderVertices(gpu);
+            renderVertices(frame);
         }
 
         // Blit rendered polygons to screen
         // For OpenGL < 3.2
-        renderBlit(gpu, !hardwareRendering);
+        renderBlit(frame, !hardwareRendering);
     }
 
     // For OpenGL > 3.2
@@ -31,7 +31,7 @@ class OpenGL {
     OpenGL();
     ~OpenGL();
     bool setup();
-    void render(gpu::GPU* gpu);
+    void render(const gpu::Frame* frame);
 
    private:
     int busToken = -1;
@@ -65,16 +65,16 @@ class OpenGL {
     bool loadExtensions();
     bool loadShaders();
     void bindRenderAttributes();
-    void renderVertices(gpu::GPU* gpu);
+    void renderVertices(const gpu::Frame* frame);
 
     std::vector<uint8_t> vram24Unpacked;
     std::vector<uint16_t> vramUnpacked;
-    void update24bitTexture(gpu::GPU* gpu);
-    void updateVramTexture(gpu::GPU* gpu);
+    void update24bitTexture(const gpu::Frame* frame);
+    void updateVramTexture(const gpu::Frame* frame);
 
     void bindBlitAttributes();
     std::vector<BlitStruct> makeBlitBuf(int screenX = 0, int screenY = 0, int screenW = 640, int screenH = 480, bool invert = false);
-    void renderBlit(gpu::GPU* gpu, bool software);
+    void renderBlit(const gpu::Frame* frame, bool software);
 
     void bindCopyAttributes();
 };
@@ -0,0 +1,96 @@
+#include "scheduler.h"
+#include <algorithm>
+#include "system.h"
+
+namespace {
+// std heap functions build max-heap, reversed comparison gives earliest event on top
+template <typename Entry>
+bool later(const Entry& a, const Entry& b) {
+    return a.time > b.time;
+}
+
+Profiler::Section section(Scheduler::Event event) {
+    switch (event) {
+        case Scheduler::Event::gpuLine: return Profiler::Section::gpu;
+        case Scheduler::Event::spuSample: return Profiler::Section::spu;
+        case Scheduler::Event::cdrom:
+        case Scheduler::Event::cdromSector: return Profiler::Section::cdrom;
+        case Scheduler::Event::controller: return Profiler::Section::controller;
+        case Scheduler::Event::dma: return Profiler::Section::dma;
+        default: return Profiler::Section::timers;
+    }
+}
+}  // namespace
+
+Scheduler::Scheduler(System* sys) : sys(sys) {
+    times.fill(0);
+    generations.fill(0);
+    active.fill(false);
+}
+
+uint64_t Scheduler::now() const { return sys->cycles * CYCLES_PER_INSTRUCTION; }
+
+void Scheduler::setHandler(Event event, std::function<void()> handler) { handlers[(size_t)event] = std::move(handler); }
+
+void Scheduler::push(Event event, uint64_t time) {
+    size_t i = (size_t)event;
+    times[i] = time;
+    active[i] = true;
+    heap.push_back({time, event, ++generations[i]});
+    std::push_heap(heap.begin(), heap.end(), later<Entry>);
+
+    if (time < sliceEnd) cpuShouldYield = true;
+}
+
+void Scheduler::schedule(Event event, uint64_t delay) { push(event, now() + delay); }
+
+void Scheduler::reschedule(Event event, uint64_t period) { push(event, times[(size_t)event] + period); }
+
+void Scheduler::cancel(Event event) {
+    size_t i = (size_t)event;
+    active[i] = false;
+    generations[i]++;
+}
+
+void Scheduler::rebuild() {
+    heap.clear();
+    for (size_t i = 0; i < EVENT_COUNT; i++) {
+        generations[i]++;
+        if (active[i]) heap.push_back({times[i], (Event)i, generations[i]});
+    }
+    std::make_heap(heap.begin(), heap.end(), later<Entry>);
+}
+
+int Scheduler::beginSlice() {
+    while (!heap.empty() && heap.front().generation != generations[(size_t)heap.front().event]) {
+        std::pop_heap(heap.begin(), heap.end(), later<Entry>);
+        heap.pop_back();
+    }
+
+    uint64_t current = now();
+    uint64_t instructions = 1;
+    if (!heap.empty() && heap.front().time > current) {
+        instructions = (heap.front().time - current + CYCLES_PER_INSTRUCTION - 1) / CYCLES_PER_INSTRUCTION;
+    }
+
+    sliceEnd = current + instructions * CYCLES_PER_INSTRUCTION;
+    cpuShouldYield = false;
+    return (int)std::min<uint64_t>(instructions, INT32_MAX);
+}
+
+void Scheduler::runDueEvents() {
+    sliceEnd = 0;
+    uint64_t current = now();
+    while (!heap.empty() && heap.front().time <= current) {
+        Entry entry = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), later<Entry>);
+        heap.pop_back();
+
+        size_t i = (size_t)entry.event;
+        if (entry.generation != generations[i]) continue;
+
+        active[i] = false;
+        Profiler::Scope scope(sys->profiler, section(entry.event));
+        if (handlers[i]) handlers[i]();
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct System;
+
+/*
+Device event scheduler.
+Time is counted in system cycles (3 per CPU instruction, derived from System::cycles).
+Devices schedule their next deadline (scanline, timer target, sector read, IRQ delay) and
+CPU runs uninterrupted until the nearest one - devices with nothing to do are not stepped at all.
+*/
+class Scheduler {
+   public:
+    enum class Event {
+        gpuLine,
+        spuSample,
+        timer0,
+        timer1,
+        timer2,
+        cdrom,
+        cdromSector,
+        controller,
+        dma,
+        COUNT
+    };
+
+    static const int CYCLES_PER_INSTRUCTION = 3;
+    // Interval of devices polled while they are active (level triggered IRQs, busy flags)
+    static const int POLL_PERIOD = 300;
+
+   private:
+    static const size_t EVENT_COUNT = (size_t)Event::COUNT;
+
+    struct Entry {
+        uint64_t time;
+        Event event;
+        uint32_t generation;
+    };
+
+    System* sys;
+    std::vector<Entry> heap;  // Min-heap, entries with old generation are stale and skipped
+    std::array<uint64_t, EVENT_COUNT> times;
+    std::array<uint32_t, EVENT_COUNT> generations;
+    std::array<bool, EVENT_COUNT> active;
+    std::array<std::function<void()>, EVENT_COUNT> handlers;
+    uint64_t sliceEnd = 0;
+
+    void push(Event event, uint64_t time);
+    void rebuild();
+
+   public:
+    bool cpuShouldYield = false;  // Event was scheduled before end of current CPU slice
+
+    Scheduler(System* sys);
+    uint64_t now() const;
+
+    void setHandler(Event event, std::function<void()> handler);
+    // Delay relative to current time
+    void schedule(Event event, uint64_t delay);
+    // Delay relative to last deadline of this event (for periodic events, no drift)
+    void reschedule(Event event, uint64_t period);
+    void cancel(Event event);
+    bool isScheduled(Event event) const { return active[(size_t)event]; }
+
+    // Returns number of CPU instructions to execute before next event
+    int beginSlice();
+    void runDueEvents();
+
+    template <class Archive>
+    void save(Archive& ar) const {
+        ar(times, active);
+    }
+
+    template <class Archive>
+    void load(Archive& ar) {
+        ar(times, active);
+        rebuild();
+    }
+};
@@ -57,17 +57,11 @@ std::vector<int16_t> decode(uint8_t buffer[16], int32_t prevSample[2]) {
     return decoded;
 }
 
-// Separate buffers and counters for left and right channels
-// TODO: Come up with better solution. Are two buffers really necessary?
-int16_t ringbuf[2][0x20] = {};
-int p[2] = {};
-int sixstep[2] = {6, 6};
-
 template <int ch>
-int16_t doZigzag(int p, int table) {
+int16_t doZigzag(const XaState& state, int p, int table) {
     int32_t sum = 0;
     for (int i = 1; i < 29; i++) {
-        sum += (ringbuf[ch][(p - i) & 0x1f] * zigzagTables[table][i]) / 0x8000;
+        sum += (state.ringbuf[ch][(p - i) & 0x1f] * zigzagTables[table][i]) / 0x8000;
     }
     return clamp_16bit(sum);
 }
@@ -75,13 +69,13 @@ int16_t doZigzag(int p, int table) {
 // sampleRate == false - 37800Hz
 // sampleRate == true  - 18900Hz - double output samples
 template <int ch>
-void interpolate(int16_t sample, std::vector<int16_t>& output, bool sampleRate = false) {
-    ringbuf[ch][p[ch]++ & 0x1f] = sample;
+void interpolate(XaState& state, int16_t sample, std::vector<int16_t>& output, bool sampleRate = false) {
+    state.ringbuf[ch][state.p[ch]++ & 0x1f] = sample;
 
-    if (--sixstep[ch] == 0) {
-        sixstep[ch] = 6;
+    if (--state.sixstep[ch] == 0) {
+        state.sixstep[ch] = 6;
         for (int table = 0; table < 7; table++) {
-            int16_t v = doZigzag<ch>(p[ch], table);
+            int16_t v = doZigzag<ch>(state, state.p[ch], table);
             output.push_back(v);
             if (sampleRate) output.push_back(v);
         }
@@ -91,7 +85,7 @@ void interpolate(int16_t sample, std::vector<int16_t>& output, bool sampleRate =
 enum class Channel { mono, left, right };
 
 template <Channel channel>
-std::vector<int16_t> decodePacket(uint8_t buffer[128], int32_t prevSample[2], bool sampleRate) {
+std::vector<int16_t> decodePacket(XaState& state, uint8_t buffer[128], int32_t prevSample[2], bool sampleRate) {
     std::vector<int16_t> decoded;
 
     std::vector<int> blocks;
@@ -133,9 +127,9 @@ std::vector<int16_t> decodePacket(uint8_t buffer[128], int32_t prevSample[2], bo
             // clamp to -0x8000 +0x7fff
             // Intepolate 37800Hz to 44100Hz
             if (channel == Channel::mono || channel == Channel::left) {
-                interpolate<0>(clamp_16bit(sample), decoded, sampleRate);
+                interpolate<0>(state, clamp_16bit(sample), decoded, sampleRate);
             } else {
-                interpolate<1>(clamp_16bit(sample), decoded, sampleRate);
+                interpolate<1>(state, clamp_16bit(sample), decoded, sampleRate);
             }
 
             // Move previous samples forward
@@ -147,23 +141,20 @@ std::vector<int16_t> decodePacket(uint8_t buffer[128], int32_t prevSample[2], bo
     return decoded;
 }
 
-std::vector<std::pair<int16_t, int16_t>> decodeXA(uint8_t buffer[128 * 18], cd::Codinginfo codinginfo) {
-    static int32_t prevSampleLeft[2] = {};
-    static int32_t prevSampleRight[2] = {};
-
+std::vector<std::pair<int16_t, int16_t>> decodeXA(uint8_t buffer[128 * 18], cd::Codinginfo codinginfo, XaState& state) {
     std::vector<std::pair<int16_t, int16_t>> frame;
 
     // Each sector contains of 18 128-byte portions
     for (int packet = 0; packet < 18; packet++) {
         if (codinginfo.stereo) {
-            auto l = decodePacket<Channel::left>(buffer + packet * 128, prevSampleLeft, codinginfo.sampleRate);
-            auto r = decodePacket<Channel::right>(buffer + packet * 128, prevSampleRight, codinginfo.sampleRate);
+            auto l = decodePacket<Channel::left>(state, buffer + packet * 128, state.prevSample[0], codinginfo.sampleRate);
+            auto r = decodePacket<Channel::right>(state, buffer + packet * 128, state.prevSample[1], codinginfo.sampleRate);
 
             for (int i = 0; i < l.size(); i++) {
                 frame.emplace_back(l[i], r[i]);
             }
         } else {
-            auto mono = decodePacket<Channel::mono>(buffer + packet * 128, prevSampleLeft, codinginfo.sampleRate);
+            auto mono = decodePacket<Channel::mono>(state, buffer + packet * 128, state.prevSample[0], codinginfo.sampleRate);
             for (auto sample : mono) {
                 frame.emplace_back(sample, sample);
             }
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Destination of audio produced by System, provided by frontend. Instances without one (batch runs) don't output audio.
+struct AudioSink {
+    virtual ~AudioSink() = default;
+    // Interleaved stereo samples
+    virtual void append(const int16_t* samples, size_t count) = 0;
+    // System was restarted, queued audio is stale
+    virtual void clear() = 0;
+};
@@ -3,10 +3,15 @@
 #include <deque>
 #include <iterator>
 #include <mutex>
+#include "sound/audio_sink.h"
+#include "sound/time_stretch.h"
 
 namespace Sound {
+const size_t MAX_BUFFER_SIZE = 512 * 32;
+
 extern std::deque<uint16_t> buffer;
 extern std::mutex audioMutex;
+extern TimeStretch timeStretch;
 
 void init();
 void play();
@@ -14,13 +19,27 @@ void stop();
 void close();
 void clearBuffer();
 
+// Emulation speed relative to real time, audio tempo follows it without changing pitch
+inline void setSpeed(double speed) {
+    std::unique_lock<std::mutex> lock(audioMutex);
+    timeStretch.setRatio(speed);
+}
+
 template <typename Iterator>
 void appendBuffer(const Iterator& start, const Iterator& end) {
     std::unique_lock<std::mutex> lock(audioMutex);
 
-    if (buffer.size() > 512 * 32) {
-        buffer.clear();
+    timeStretch.process(&*start, std::distance(start, end), buffer);
+
+    // Output can't keep up - drop the oldest samples (keeping channels in order) instead of whole buffer
+    if (buffer.size() > MAX_BUFFER_SIZE) {
+        buffer.erase(buffer.begin(), buffer.begin() + ((buffer.size() - MAX_BUFFER_SIZE) & ~1));
     }
-    buffer.insert(buffer.end(), start, end);
 }
+
+// Plays audio of System it's attached to on the output device
+struct Output : AudioSink {
+    void append(const int16_t* samples, size_t count) override { appendBuffer(samples, samples + count); }
+    void clear() override { clearBuffer(); }
+};
 };  // namespace Sound
@@ -0,0 +1,72 @@
+#include "time_stretch.h"
+#include <algorithm>
+#include <cmath>
+
+void TimeStretch::reset() {
+    input.clear();
+    tail.clear();
+    position = 0.0;
+}
+
+void TimeStretch::setRatio(double ratio) {
+    ratio = std::max(ratio, 1.0 / 8.0);
+    if (isActive() != (ratio != 1.0)) reset();
+    this->ratio = ratio;
+}
+
+// Offset from start where input resembles tail the most (normalized cross-correlation of L+R)
+int TimeStretch::bestOffset(size_t start) const {
+    int best = 0;
+    double bestScore = -1e30;
+    for (int offset = 0; offset < SEARCH; offset++) {
+        const int16_t* candidate = &input[(start + offset) * 2];
+        double correlation = 0.0, energy = 1.0;
+        for (int i = 0; i < OVERLAP; i++) {
+            double a = tail[i * 2] + tail[i * 2 + 1];
+            double b = candidate[i * 2] + candidate[i * 2 + 1];
+            correlation += a * b;
+            energy += b * b;
+        }
+        double score = correlation / std::sqrt(energy);
+        if (score > bestScore) {
+            bestScore = score;
+            best = offset;
+        }
+    }
+    return best;
+}
+
+void TimeStretch::process(const int16_t* samples, size_t count, std::deque<uint16_t>& output) {
+    if (!isActive()) {
+        output.insert(output.end(), samples, samples + count);
+        return;
+    }
+
+    input.insert(input.end(), samples, samples + count);
+
+    while (frames() >= (size_t)position + SEARCH + SEGMENT + OVERLAP) {
+        size_t start = (size_t)position;
+        size_t segment = start;
+        int copied = 0;
+
+        if (!tail.empty()) {
+            segment += bestOffset(start);
+            for (int i = 0; i < OVERLAP * 2; i++) {
+                int frame = i / 2;
+                int mixed = (tail[i] * (OVERLAP - frame) + input[segment * 2 + i] * frame) / OVERLAP;
+                output.push_back((uint16_t)(int16_t)mixed);
+            }
+            copied = OVERLAP;
+        }
+
+        for (size_t i = (segment + copied) * 2; i < (segment + SEGMENT) * 2; i++) output.push_back((uint16_t)input[i]);
+        tail.assign(input.begin() + (segment + SEGMENT) * 2, input.begin() + (segment + SEGMENT + OVERLAP) * 2);
+
+        position += SEGMENT * ratio;
+
+        // Input before nominal position is not needed anymore
+        size_t consumed = std::min((size_t)position, frames());
+        input.erase(input.begin(), input.begin() + consumed * 2);
+        position -= consumed;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Changes tempo of interleaved stereo audio without changing its pitch (WSOLA).
+// Input is copied to output in segments joined with crossfade, start of every segment is searched
+// near its nominal position for best match with audio it continues - waveform stays continuous.
+class TimeStretch {
+    static const int SEGMENT = 1024;  // Frames copied from input per step
+    static const int OVERLAP = 256;   // Crossfade length
+    static const int SEARCH = 256;    // Range searched for best continuation
+
+    std::vector<int16_t> input;
+    std::vector<int16_t> tail;  // Input following previously copied segment, crossfaded with next one
+    double position = 0.0;      // Nominal start of next segment (in input frames)
+    double ratio = 1.0;
+
+    size_t frames() const { return input.size() / 2; }
+    int bestOffset(size_t start) const;
+
+   public:
+    // Drops buffered input, next segment starts from scratch
+    void reset();
+    bool isActive() const { return ratio != 1.0; }
+    // Input frames consumed per output frame, 1.0 - passthrough
+    void setRatio(double ratio);
+    void process(const int16_t* samples, size_t count, std::deque<uint16_t>& output);
+};
@@ -20,7 +20,7 @@ namespace state {
 const char* lastSaveName = "last.state";
 
 struct StateMetadata {
-    inline static const uint32_t SAVESTATE_VERSION = 5;
+    inline static const uint32_t SAVESTATE_VERSION = 7;
 
     uint32_t version = SAVESTATE_VERSION;
     std::string biosPath;
@@ -59,6 +59,7 @@ struct StateMetadata {
         ar(discPath);
 
         ar(*sys);
+        sys->cpu->blockCache.clear();
 
         if (!biosPath.empty() && biosPath != sys->biosPath) {
             sys->loadBios(biosPath);
@@ -68,7 +69,7 @@ struct StateMetadata {
             std::unique_ptr<disc::Disc> disc = disc::load(discPath);
             if (!disc) {
                 sys->cdrom->setShell(true);
-                toast(fmt::format("Cannot load {}", discPath));
+                sys->toast(fmt::format("Cannot load {}", discPath));
             } else {
                 sys->cdrom->disc = std::move(disc);
             }
@@ -95,7 +96,7 @@ bool load(System* sys, const SaveState& state) {
     try {
         archive(metadata);
     } catch (std::exception& e) {
-        toast("Incompatible save state version");
+        sys->toast("Incompatible save state version");
         sys->state = System::State::halted;
         return false;
     }
@@ -140,9 +141,9 @@ void quickSave(System* sys, int slot) {
     auto path = getStatePath(sys, slot);
     auto state = state::save(sys);
     if (putFileContents(path, state)) {
-        toast(fmt::format("State {} saved", slot));
+        sys->toast(fmt::format("State {} saved", slot));
     } else {
-        toast(fmt::format("Cannot save state {}", slot));
+        sys->toast(fmt::format("Cannot save state {}", slot));
     }
 }
 
@@ -150,11 +151,11 @@ void quickLoad(System* sys, int slot) {
     auto path = getStatePath(sys, slot);
     auto state = getFileContentsAsString(path);
     if (state.empty()) {
-        toast(fmt::format("Cannot load state {}", slot));
+        sys->toast(fmt::format("Cannot load state {}", slot));
         return;
     }
     if (state::load(sys, state)) {
-        toast(fmt::format("State {} loaded", slot));
+        sys->toast(fmt::format("State {} loaded", slot));
     }
 }
 
@@ -172,7 +173,7 @@ void manageTimeTravel(System* sys) {
     if (now - lastTime >= timeTravelInterval) {
         lastTime = now;
 
-        bool timeTravelEnabled = config.options.emulator.timeTravel;
+        bool timeTravelEnabled = sys->config.options.emulator.timeTravel;
         if (!timeTravelEnabled) {
             return;
         }
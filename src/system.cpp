@@ -2,24 +2,49 @@
 #include <fmt/core.h>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include "bios/functions.h"
 #include "config.h"
-#include "sound/sound.h"
 #include "utils/address.h"
 #include "utils/gpu_draw_list.h"
 #include "utils/file.h"
 #include "utils/psx_exe.h"
 
-System::System() {
+namespace {
+template <size_t size>
+std::array<uint8_t, size>& placeArray(uint8_t* memory) {
+    return *new (memory) std::array<uint8_t, size>;
+}
+
+// Registers without read side effects, which change only when device event is handled
+INLINE bool isStatusRegister(uint32_t addr) {
+    return in_range<0x1f801070, 8>(addr)        // I_STAT, I_MASK
+           || in_range<0x1f801080, 0x80>(addr)  // DMA
+           || addr == 0x1f801800                // CDROM status
+           || in_range<0x1f801814, 4>(addr)     // GPUSTAT
+           || in_range<0x1f801daa, 6>(addr);    // SPUCNT, transfer control, SPUSTAT
+}
+}  // namespace
+
+System::System(const avocado_config_t& config, std::shared_ptr<Dexode::EventBus> bus)
+    : config(config),
+      bus(std::move(bus)),
+      fastmem(std::make_unique<Fastmem>()),
+      bios(placeArray<BIOS_SIZE>(fastmem->bios)),
+      ram(placeArray<RAM_SIZE>(fastmem->ram)),
+      scratchpad(placeArray<SCRATCHPAD_SIZE>(fastmem->scratchpad)),
+      expansion(placeArray<EXPANSION_SIZE>(fastmem->expansion)) {
     bios.fill(0);
     ram.fill(0);
     scratchpad.fill(0);
     expansion.fill(0);
+    mapMemory();
 
+    scheduler = std::make_unique<Scheduler>(this);
     cpu = std::make_unique<mips::CPU>(this);
     gpu = std::make_unique<gpu::GPU>(this);
     spu = std::make_unique<spu::SPU>(this);
-    mdec = std::make_unique<mdec::MDEC>();
+    mdec = std::make_unique<mdec::MDEC>(config.debug.log.mdec);
 
     cdrom = std::make_unique<device::cdrom::CDROM>(this);
     controller = std::make_unique<device::controller::Controller>(this);
@@ -35,8 +60,25 @@ System::System() {
 
     debugOutput = config.debug.log.system;
     biosLog = config.debug.log.bios;
-
-    cycles = 0;
+    setFastmem(config.options.emulator.fastmem);
+    setHle(config.options.emulator.hle);
+
+    using Event = Scheduler::Event;
+    scheduler->setHandler(Event::gpuLine, [this] { handleGpuLine(); });
+    scheduler->setHandler(Event::spuSample, [this] { handleSpuSample(); });
+    scheduler->setHandler(Event::cdrom, [this] { cdrom->step(); });
+    scheduler->setHandler(Event::cdromSector, [this] { cdrom->stepRead(); });
+    scheduler->setHandler(Event::controller, [this] { controller->step(); });
+    scheduler->setHandler(Event::dma, [this] { dma->step(); });
+    for (int t : {0, 1, 2}) {
+        scheduler->setHandler((Event)((int)Event::timer0 + t), [this, t] {
+            timer[t]->sync();
+            timer[t]->scheduleIrq();
+        });
+        timer[t]->scheduleIrq();
+    }
+    scheduler->schedule(Event::gpuLine, gpu::CYCLES_PER_LINE_NTSC);
+    scheduler->schedule(Event::spuSample, spuSamplePeriod());
 }
 
 // Note: stupid static_casts and asserts are only to suppress MSVC warnings
@@ -65,10 +107,27 @@ constexpr void write_fast(uint8_t* device, uint32_t addr, T value) {
         ((uint32_t*)device)[addr / 4] = static_cast<uint32_t>(value);
 }
 
+// Devices can implement full width register access (read16/read32/write16/write32),
+// accesses of other widths are split into byte reads/writes
+#define IO_ACCESS_TRAIT(name, call)                                                                 \
+    template <typename Device, typename = void>                                                     \
+    struct name : std::false_type {};                                                               \
+    template <typename Device>                                                                      \
+    struct name<Device, std::void_t<decltype(std::declval<Device&>()->call)>> : std::true_type {};
+
+IO_ACCESS_TRAIT(HasRead16, read16(0));
+IO_ACCESS_TRAIT(HasRead32, read32(0));
+IO_ACCESS_TRAIT(HasWrite16, write16(0, 0));
+IO_ACCESS_TRAIT(HasWrite32, write32(0, 0));
+#undef IO_ACCESS_TRAIT
+
 template <typename T, typename Device>
 constexpr T read_io(Device& periph, uint32_t addr) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type used");
 
+    if constexpr (sizeof(T) == 2 && HasRead16<Device>::value) return periph->read16(addr);
+    if constexpr (sizeof(T) == 4 && HasRead32<Device>::value) return periph->read32(addr);
+
     if (sizeof(T) == 1) return periph->read(addr);
     if (sizeof(T) == 2) return periph->read(addr) | periph->read(addr + 1) << 8;
     if (sizeof(T) == 4)
@@ -80,6 +139,9 @@ template <typename T, typename Device>
 constexpr void write_io(Device& periph, uint32_t addr, T data) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type used");
 
+    if constexpr (sizeof(T) == 2 && HasWrite16<Device>::value) return periph->write16(addr, data);
+    if constexpr (sizeof(T) == 4 && HasWrite32<Device>::value) return periph->write32(addr, data);
+
     if (sizeof(T) == 1) {
         periph->write(addr, (static_cast<uint8_t>(data)) & 0xff);
     } else if (sizeof(T) == 2) {
@@ -93,22 +155,73 @@ constexpr void write_io(Device& periph, uint32_t addr, T data) {
     }
 }
 
+// I/O ports: name, begin, end, device, access (IO - any width, IO32 - 32bit only)
+#define IO_PORTS(X)                                             \
+    X(memoryControl, 0x1f801000, 0x1f801024, memoryControl, IO) \
+    X(controller, 0x1f801040, 0x1f801050, controller, IO)       \
+    X(serial, 0x1f801050, 0x1f801060, serial, IO)               \
+    X(ramSize, 0x1f801060, 0x1f801064, memoryControl, IO)       \
+    X(interrupt, 0x1f801070, 0x1f801078, interrupt, IO)         \
+    X(dma, 0x1f801080, 0x1f801100, dma, IO)                     \
+    X(timer0, 0x1f801100, 0x1f801110, timer[0], IO)             \
+    X(timer1, 0x1f801110, 0x1f801120, timer[1], IO)             \
+    X(timer2, 0x1f801120, 0x1f801130, timer[2], IO)             \
+    X(cdrom, 0x1f801800, 0x1f801804, cdrom, IO)                 \
+    X(gpu, 0x1f801810, 0x1f801818, gpu, IO32)                   \
+    X(mdec, 0x1f801820, 0x1f801828, mdec, IO32)                 \
+    X(spu, 0x1f801C00, 0x1f802000, spu, IO)                     \
+    X(expansion2, 0x1f802000, 0x1f804000, expansion2, IO)
+
+namespace {
+#define IO_PORT_NAME(name, begin, end, periph, access) name,
+enum class IoPort : uint8_t { none, IO_PORTS(IO_PORT_NAME) };
+#undef IO_PORT_NAME
+
+const uint32_t IO_MAP_BASE = 0x1f801000;
+const uint32_t IO_MAP_SIZE = 0x3000;
+const uint32_t IO_MAP_GRANULARITY = 4;  // All ports are word aligned
+
+// Port for each word of I/O space, single lookup instead of comparing address with every port range
+constexpr auto IO_MAP = [] {
+    struct Range {
+        IoPort port;
+        uint32_t begin, end;
+    };
+#define IO_PORT_RANGE(name, begin, end, periph, access) {IoPort::name, begin, end},
+    const Range ranges[] = {IO_PORTS(IO_PORT_RANGE)};
+#undef IO_PORT_RANGE
+
+    std::array<IoPort, IO_MAP_SIZE / IO_MAP_GRANULARITY> map{};
+    for (const auto& range : ranges) {
+        for (uint32_t addr = range.begin; addr < range.end; addr += IO_MAP_GRANULARITY) {
+            map[(addr - IO_MAP_BASE) / IO_MAP_GRANULARITY] = range.port;
+        }
+    }
+    return map;
+}();
+
+INLINE IoPort ioPort(uint32_t addr) {
+    if (!in_range<IO_MAP_BASE, IO_MAP_SIZE>(addr)) return IoPort::none;
+    return IO_MAP[(addr - IO_MAP_BASE) / IO_MAP_GRANULARITY];
+}
+}  // namespace
+
 #ifdef ENABLE_IO_LOG
 #define LOG_IO(mode, size, addr, data, pc) ioLogList.push_back({(mode), (size), (addr), (data), (pc)})
 #else
 #define LOG_IO(mode, size, addr, data, pc)
 #endif
 
-#define READ_IO(begin, end, periph)                                              \
-    if (addr >= (begin) && addr < (end)) {                                       \
+#define READ_IO(port, begin, periph)                                             \
+    case IoPort::port: {                                                         \
         auto data = read_io<T>((periph), addr - (begin));                        \
                                                                                  \
         LOG_IO(IO_LOG_ENTRY::MODE::READ, sizeof(T) * 8, address, data, cpu->PC); \
         return data;                                                             \
     }
 
-#define READ_IO32(begin, end, periph)                                                                                    \
-    if (addr >= (begin) && addr < (end)) {                                                                               \
+#define READ_IO32(port, begin, periph)                                                                                   \
+    case IoPort::port: {                                                                                                 \
         T data = 0;                                                                                                      \
         if (sizeof(T) == 4) {                                                                                            \
             data = (periph)->read(addr - (begin));                                                                       \
@@ -120,16 +233,16 @@ constexpr void write_io(Device& periph, uint32_t addr, T data) {
         return data;                                                                                                     \
     }
 
-#define WRITE_IO(begin, end, periph)                                              \
-    if (addr >= (begin) && addr < (end)) {                                        \
+#define WRITE_IO(port, begin, periph)                                             \
+    case IoPort::port: {                                                          \
         write_io<T>((periph), addr - (begin), data);                              \
                                                                                   \
         LOG_IO(IO_LOG_ENTRY::MODE::WRITE, sizeof(T) * 8, address, data, cpu->PC); \
         return;                                                                   \
     }
 
-#define WRITE_IO32(begin, end, periph)                                                                                   \
-    if (addr >= (begin) && addr < (end)) {                                                                               \
+#define WRITE_IO32(port, begin, periph)                                                                                  \
+    case IoPort::port: {                                                                                                 \
         if (sizeof(T) == 4) {                                                                                            \
             (periph)->write(addr - (begin), data);                                                                       \
         } else {                                                                                                         \
@@ -140,39 +253,30 @@ constexpr void write_io(Device& periph, uint32_t addr, T data) {
         return;                                                                                                          \
     }
 
+#define READ_PORT(name, begin, end, periph, access) READ_##access(name, begin, periph)
+#define WRITE_PORT(name, begin, end, periph, access) WRITE_##access(name, begin, periph)
+
 template <typename T>
 INLINE T System::readMemory(uint32_t address) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type used");
 
     uint32_t addr = align_mips<T>(address);
 
-    if (in_range<RAM_BASE, RAM_SIZE * 4>(addr)) {
-        return read_fast<T>(ram.data(), (addr - RAM_BASE) & (RAM_SIZE - 1));
-    }
-    if (in_range<EXPANSION_BASE, EXPANSION_SIZE>(addr)) {
-        return read_fast<T>(expansion.data(), addr - EXPANSION_BASE);
+    uint8_t* page = readPages[addr / PAGE_SIZE];
+    if (likely(page != nullptr)) {
+        return read_fast<T>(page, addr & (PAGE_SIZE - 1));
     }
+
     if (in_range<SCRATCHPAD_BASE, SCRATCHPAD_SIZE>(addr)) {
         return read_fast<T>(scratchpad.data(), addr - SCRATCHPAD_BASE);
     }
-    if (in_range<BIOS_BASE, BIOS_SIZE>(addr)) {
-        return read_fast<T>(bios.data(), addr - BIOS_BASE);
-    }
-
-    READ_IO(0x1f801000, 0x1f801024, memoryControl);
-    READ_IO(0x1f801040, 0x1f801050, controller);
-    READ_IO(0x1f801050, 0x1f801060, serial);
-    READ_IO(0x1f801060, 0x1f801064, memoryControl);
-    READ_IO(0x1f801070, 0x1f801078, interrupt);
-    READ_IO(0x1f801080, 0x1f801100, dma);
-    READ_IO(0x1f801100, 0x1f801110, timer[0]);
-    READ_IO(0x1f801110, 0x1f801120, timer[1]);
-    READ_IO(0x1f801120, 0x1f801130, timer[2]);
-    READ_IO(0x1f801800, 0x1f801804, cdrom);
-    READ_IO32(0x1f801810, 0x1f801818, gpu);
-    READ_IO32(0x1f801820, 0x1f801828, mdec);
-    READ_IO(0x1f801C00, 0x1f802000, spu);
-    READ_IO(0x1f802000, 0x1f804000, expansion2);
+
+    if (!isStatusRegister(addr)) volatileRead = true;
+
+    switch (ioPort(addr)) {
+        IO_PORTS(READ_PORT)
+        case IoPort::none: break;
+    }
 
     if (in_range<0xfffe0130, 4>(address) && sizeof(T) == 4) {
         auto data = cacheControl->read(0);
@@ -198,30 +302,25 @@ INLINE void System::writeMemory(uint32_t address, T data) {
 
     uint32_t addr = align_mips<T>(address);
 
-    if (in_range<RAM_BASE, RAM_SIZE * 4>(addr)) {
-        return write_fast<T>(ram.data(), (addr - RAM_BASE) & (RAM_SIZE - 1), data);
+    uint8_t* page = writePages[addr / PAGE_SIZE];
+    if (likely(page != nullptr)) {
+        return write_fast<T>(page, addr & (PAGE_SIZE - 1), data);
     }
-    if (in_range<EXPANSION_BASE, EXPANSION_SIZE>(addr)) {
-        return write_fast<T>(expansion.data(), addr - EXPANSION_BASE, data);
+
+    // RAM page write protected by block cache
+    if (in_range<RAM_BASE, RAM_SIZE * 4>(addr)) {
+        uint32_t ramAddress = (addr - RAM_BASE) & (RAM_SIZE - 1);
+        cpu->blockCache.invalidate(ramAddress);
+        return write_fast<T>(ram.data(), ramAddress, data);
     }
     if (in_range<SCRATCHPAD_BASE, SCRATCHPAD_SIZE>(addr)) {
         return write_fast<T>(scratchpad.data(), addr - SCRATCHPAD_BASE, data);
     }
 
-    WRITE_IO(0x1f801000, 0x1f801024, memoryControl);
-    WRITE_IO(0x1f801040, 0x1f801050, controller);
-    WRITE_IO(0x1f801050, 0x1f801060, serial);
-    WRITE_IO(0x1f801060, 0x1f801064, memoryControl);
-    WRITE_IO(0x1f801070, 0x1f801078, interrupt);
-    WRITE_IO(0x1f801080, 0x1f801100, dma);
-    WRITE_IO(0x1f801100, 0x1f801110, timer[0]);
-    WRITE_IO(0x1f801110, 0x1f801120, timer[1]);
-    WRITE_IO(0x1f801120, 0x1f801130, timer[2]);
-    WRITE_IO(0x1f801800, 0x1f801804, cdrom);
-    WRITE_IO32(0x1f801810, 0x1f801818, gpu);
-    WRITE_IO32(0x1f801820, 0x1f801828, mdec);
-    WRITE_IO(0x1f801C00, 0x1f802000, spu);
-    WRITE_IO(0x1f802000, 0x1f804000, expansion2);
+    switch (ioPort(addr)) {
+        IO_PORTS(WRITE_PORT)
+        case IoPort::none: break;
+    }
 
     if (in_range<0xfffe0130, 4>(address) && sizeof(T) == 4) {
         cacheControl->write(0, data);
@@ -233,6 +332,60 @@ INLINE void System::writeMemory(uint32_t address, T data) {
     cpu->busError();
 }
 
+void System::mapMemory() {
+    readPages.fill(nullptr);
+    writePages.fill(nullptr);
+
+    for (uint32_t offset = 0; offset < RAM_SIZE * 4; offset += PAGE_SIZE) {
+        uint8_t* page = ram.data() + (offset & (RAM_SIZE - 1));
+        readPages[(RAM_BASE + offset) / PAGE_SIZE] = page;
+        writePages[(RAM_BASE + offset) / PAGE_SIZE] = page;
+    }
+    for (uint32_t offset = 0; offset < EXPANSION_SIZE; offset += PAGE_SIZE) {
+        readPages[(EXPANSION_BASE + offset) / PAGE_SIZE] = expansion.data() + offset;
+        writePages[(EXPANSION_BASE + offset) / PAGE_SIZE] = expansion.data() + offset;
+    }
+    for (uint32_t offset = 0; offset < BIOS_SIZE; offset += PAGE_SIZE) {
+        readPages[(BIOS_BASE + offset) / PAGE_SIZE] = bios.data() + offset;
+    }
+}
+
+void System::protectRamPage(uint32_t page, bool protect) {
+    for (uint32_t mirror = 0; mirror < 4; mirror++) {
+        uint32_t offset = mirror * RAM_SIZE + page * PAGE_SIZE;
+        writePages[(RAM_BASE + offset) / PAGE_SIZE] = protect ? nullptr : ram.data() + page * PAGE_SIZE;
+    }
+    fastmem->protectRamPage(page, protect);
+}
+
+void System::ramWritten(uint32_t address, uint32_t size) {
+    for (uint32_t page = address / PAGE_SIZE; page <= (address + size - 1) / PAGE_SIZE; page++) {
+        cpu->blockCache.invalidate((page * PAGE_SIZE) & (RAM_SIZE - 1));
+    }
+}
+
+void System::setFastmem(bool enabled) {
+    if (enabled == (fastmem->getArena() != nullptr)) return;
+
+    // Compiled code depends on memory access method
+    cpu->blockCache.clear();
+    if (cpu->recompiler) cpu->recompiler->reset();
+
+    if (!enabled) {
+        fastmem->disable();
+    } else if (!fastmem->enable()) {
+        fmt::print("[SYS] Fastmem is not supported on this platform\n");
+    }
+}
+
+void System::setHle(const std::unordered_map<std::string, bool>& options) {
+    for (auto& table : hleRoutines) table.fill(nullptr);
+    for (const auto& routine : bios::hle::routines) {
+        auto option = options.find(routine.option);
+        if (option != options.end() && option->second) hleRoutines[routine.table][routine.number] = &routine;
+    }
+}
+
 uint8_t System::readMemory8(uint32_t address) { return readMemory<uint8_t>(address); }
 
 uint16_t System::readMemory16(uint32_t address) { return readMemory<uint16_t>(address); }
@@ -283,20 +436,20 @@ void System::printFunctionInfo(const char* functionNum, const bios::Function& f)
     fmt::print(")\n");
 }
 
-void System::handleBiosFunction() {
+bool System::handleBiosFunction() {
     uint32_t maskedPC = cpu->PC & 0x1FFFFF;
     uint8_t functionNumber = cpu->reg[9];
     bool log = biosLog;
 
     int tableNum = (maskedPC - 0xA0) / 0x10;
-    if (tableNum > 2) return;
+    if (tableNum > 2) return false;
 
     const auto& table = bios::tables[tableNum];
     const auto& function = table.find(functionNumber);
 
     if (function == table.end()) {
         fmt::print("  BIOS {:1X}(0x{:02X}): Unknown function!\n", 0xA + tableNum, functionNumber);
-        return;
+        return false;
     }
     if (function->second.callback != nullptr) {
         log = function->second.callback(this);
@@ -306,6 +459,24 @@ void System::handleBiosFunction() {
         std::string type = fmt::format("BIOS {:1X}({:02X})", 0xA + tableNum, functionNumber);
         printFunctionInfo(type.c_str(), function->second);
     }
+
+    const bios::hle::Routine* routine = hleRoutines[tableNum][functionNumber];
+    if (routine == nullptr || !bios::hle::isBiosEntry(this, *routine)) return false;
+
+    // Load in delay slot of the call lands before the first instruction of called function
+    const auto pendingLoad = cpu->slots[0];
+    const uint32_t overwritten = cpu->reg[pendingLoad.reg];
+    cpu->moveLoadDelaySlots();
+    if (!routine->handler(this)) {
+        // Handlers leave registers untouched on fallback - BIOS code runs with the load still pending
+        cpu->reg[pendingLoad.reg] = overwritten;
+        cpu->slots[1] = cpu->slots[0];
+        cpu->slots[0] = pendingLoad;
+        return false;
+    }
+
+    cpu->setPC(cpu->reg[31]);
+    return true;
 }
 
 void System::handleSyscallFunction() {
@@ -330,17 +501,53 @@ void System::singleStep() {
     cpu->executeInstructions(1);
     state = State::pause;
 
-    dma->step();
-    cdrom->step();
-    timer[0]->step(3);
-    timer[1]->step(3);
-    timer[2]->step(3);
-    controller->step();
-    spu->step(cdrom.get());
+    scheduler->runDueEvents();
+}
 
-    if (gpu->emulateGpuCycles(3)) {
+void System::handleGpuLine() {
+    if (gpu->emulateGpuCycles(gpu::CYCLES_PER_LINE_NTSC - gpu->gpuDot)) {
         interrupt->trigger(interrupt::VBLANK);
+        frameDone = true;
+    } else if (gpu->gpuLine > gpu::LINE_VBLANK_START_NTSC) {
+        // TODO: Move this code to Timer class
+        auto& t = *timer[1];
+        if (t.mode.syncEnabled) {
+            using modes = device::timer::CounterMode::SyncMode1;
+            auto mode1 = static_cast<modes>(t.mode.syncMode);
+            t.sync();
+            if (mode1 == modes::resetAtVblank || mode1 == modes::resetAtVblankAndPauseOutside) {
+                t.current._reg = 0;
+            } else if (mode1 == modes::pauseUntilVblankAndFreerun) {
+                t.paused = false;
+                t.mode.syncEnabled = false;
+            }
+            t.scheduleIrq();
+        }
+    }
+    scheduler->reschedule(Scheduler::Event::gpuLine, gpu::CYCLES_PER_LINE_NTSC);
+}
+
+void System::handleSpuSample() {
+    spu->step(cdrom.get());
+
+    if (spu->bufferReady) {
+        spu->bufferReady = false;
+        if (audioSink) audioSink->append(spu->audioBuffer.data(), spu->audioBuffer.size());
     }
+    scheduler->reschedule(Scheduler::Event::spuSample, spuSamplePeriod());
+}
+
+int System::spuSamplePeriod() {
+    float magicNumber = 1.575f;
+    if (!gpu->isNtsc()) {
+        // Hack to prevent crackling audio on PAL games
+        // Note - this overclocks SPU clock, bugs might appear.
+        magicNumber *= 50.f / 60.f;
+    }
+    spuCycles += magicNumber * (float)0x300;
+    int period = (int)spuCycles;
+    spuCycles -= period;
+    return period;
 }
 
 void System::emulateFrame() {
@@ -349,79 +556,31 @@ void System::emulateFrame() {
 #endif
     cpu->gte.log.clear();
 
-    if (GpuDrawList::currentFrame == 0) {
-        gpu->prevVram = gpu->vram;
-
-        // Save initial state
-        if (gpu->gpuLogEnabled) {
-            gpu->gpuLogList.clear();
-            GpuDrawList::dumpInitialState(gpu.get());
-        }
+    // Save initial state
+    if (capturedFrames == 0 && gpu->gpuLogEnabled) {
+        gpu->flushDeferred();
+        gpu->gpuLogList.clear();
+        GpuDrawList::dumpInitialState(gpu.get());
     }
 
-    if (++GpuDrawList::currentFrame >= GpuDrawList::framesToCapture) {
-        GpuDrawList::currentFrame = 0;
-        if (GpuDrawList::framesToCapture != 0) {
-            toast(fmt::format("{} frames capture complete", GpuDrawList::framesToCapture));
-            GpuDrawList::framesToCapture = 0;
+    if (++capturedFrames >= framesToCapture) {
+        capturedFrames = 0;
+        if (framesToCapture != 0) {
+            toast(fmt::format("{} frames capture complete", framesToCapture));
+            framesToCapture = 0;
             state = State::pause;
             return;
         }
     }
 
-    int systemCycles = 300;
+    frameDone = false;
     for (;;) {
-        if (!cpu->executeInstructions(systemCycles / 3)) {
-            return;
-        }
-
-        dma->step();
-        cdrom->step();
-        timer[0]->step(systemCycles);
-        timer[1]->step(systemCycles);
-        timer[2]->step(systemCycles);
-
-        static float spuCounter = 0;
-
-        float magicNumber = 1.575f;
-        if (!gpu->isNtsc()) {
-            // Hack to prevent crackling audio on PAL games
-            // Note - this overclocks SPU clock, bugs might appear.
-            magicNumber *= 50.f / 60.f;
-        }
-        spuCounter += (float)systemCycles / magicNumber / (float)0x300;
-        if (spuCounter >= 1.f) {
-            spu->step(cdrom.get());
-            spuCounter -= 1.0f;
-        }
+        scheduler->runDueEvents();
+        if (frameDone) return;  // frame emulated
 
-        if (spu->bufferReady) {
-            spu->bufferReady = false;
-            Sound::appendBuffer(spu->audioBuffer.begin(), spu->audioBuffer.end());
-        }
-
-        controller->step();
-
-        if (gpu->emulateGpuCycles(systemCycles)) {
-            interrupt->trigger(interrupt::VBLANK);
-            return;  // frame emulated
-        }
-
-        // TODO: Move this code to Timer class
-        if (gpu->gpuLine > gpu::LINE_VBLANK_START_NTSC) {
-            auto& t = *timer[1];
-            if (t.mode.syncEnabled) {
-                using modes = device::timer::CounterMode::SyncMode1;
-                auto mode1 = static_cast<modes>(timer[1]->mode.syncMode);
-                if (mode1 == modes::resetAtVblank || mode1 == modes::resetAtVblankAndPauseOutside) {
-                    timer[1]->current._reg = 0;
-                } else if (mode1 == modes::pauseUntilVblankAndFreerun) {
-                    timer[1]->paused = false;
-                    timer[1]->mode.syncEnabled = false;
-                }
-            }
+        if (!cpu->executeInstructions(scheduler->beginSlice())) {
+            return;
         }
-        // Handle Timer1 - Reset on VBlank
     }
 }
 
@@ -478,6 +637,7 @@ bool System::loadBios(const std::string& path) {
     }
 
     std::copy(_bios.begin(), _bios.end(), bios.begin());
+    cpu->blockCache.clear();
     this->biosPath = path;
     state = State::run;
     biosLoaded = true;
@@ -505,3 +665,5 @@ void System::dumpRam() {
     std::vector<uint8_t> ram(this->ram.begin(), this->ram.end());
     putFileContents("ram.bin", ram);
 }
+
+void System::toast(const std::string& message) { bus->notify(Event::Gui::Toast{message}); }
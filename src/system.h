@@ -1,5 +1,7 @@
 #pragma once
 #include <cstdint>
+#include "bios/hle.h"
+#include "config.h"
 #include "cpu/cpu.h"
 #include "device/cache_control.h"
 #include "device/cdrom/cdrom.h"
@@ -13,9 +15,15 @@
 #include "device/serial.h"
 #include "device/spu/spu.h"
 #include "device/timer.h"
+#include "fastmem.h"
+#include "scheduler.h"
+#include "sound/audio_sink.h"
 #include "utils/macros.h"
+#include "utils/profiler.h"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -54,17 +62,48 @@ struct System {
     static const int SCRATCHPAD_SIZE = 1024;
     static const int EXPANSION_SIZE = 1 * 1024 * 1024;
     static const int IO_SIZE = 0x2000;
+
+    static const int PAGE_SIZE = 4 * 1024;
+    static const int PAGE_COUNT = 0x20000000 / PAGE_SIZE;  // Whole physical address space (KUSEG/KSEG0/KSEG1 mirror it)
     State state = State::stop;
 
-    std::array<uint8_t, BIOS_SIZE> bios;
-    std::array<uint8_t, RAM_SIZE> ram;
-    std::array<uint8_t, SCRATCHPAD_SIZE> scratchpad;
-    std::array<uint8_t, EXPANSION_SIZE> expansion;
+    // Instance settings and event bus, devices use them instead of process globals
+    // so multiple Systems can run in parallel. Must be declared before devices.
+    avocado_config_t config;
+    std::shared_ptr<Dexode::EventBus> bus;
+    std::shared_ptr<AudioSink> audioSink;  // Not set - SPU output is discarded
+
+    // Owns memory below, must be declared before it
+    std::unique_ptr<Fastmem> fastmem;
+
+    std::array<uint8_t, BIOS_SIZE>& bios;
+    std::array<uint8_t, RAM_SIZE>& ram;
+    std::array<uint8_t, SCRATCHPAD_SIZE>& scratchpad;
+    std::array<uint8_t, EXPANSION_SIZE>& expansion;
+
+    // Host pointer for each physical page accessible directly (RAM with mirrors, expansion, BIOS)
+    // nullptr - access goes through slow path (scratchpad, I/O, unmapped, RAM pages containing compiled code)
+    std::array<uint8_t*, PAGE_COUNT> readPages;
+    std::array<uint8_t*, PAGE_COUNT> writePages;
 
     bool debugOutput = true;  // Print BIOS logs
     bool biosLoaded = false;
 
-    uint64_t cycles;
+    uint64_t cycles = 0;
+    bool volatileRead = false;  // I/O register other than device status was read (see CPU::skipIdleLoop)
+
+    std::unique_ptr<Scheduler> scheduler;
+    Profiler profiler;
+
+    // Enabled native routine for each A0/B0/C0 function, nullptr - BIOS code is executed
+    std::array<std::array<const bios::hle::Routine*, 256>, 3> hleRoutines{};
+    bios::hle::Heap hleHeap;
+    bool frameDone = false;
+    float spuCycles = 0;  // Fractional part of SPU sample period
+
+    // GPU draw list capture (see utils/gpu_draw_list.h)
+    int framesToCapture = 0;
+    int capturedFrames = 0;
 
     // Devices
     std::unique_ptr<mips::CPU> cpu;
@@ -87,10 +126,15 @@ struct System {
     template <typename T>
     INLINE void writeMemory(uint32_t address, T data);
     void singleStep();
-    void handleBiosFunction();
+    void handleGpuLine();
+    void handleSpuSample();
+    int spuSamplePeriod();
+    // Returns true if native routine was executed and CPU returned to the caller
+    bool handleBiosFunction();
     void handleSyscallFunction();
 
-    System();
+    explicit System(const avocado_config_t& config = avocado_config_t(),
+                    std::shared_ptr<Dexode::EventBus> bus = std::make_shared<Dexode::EventBus>());
     uint8_t readMemory8(uint32_t address);
     uint16_t readMemory16(uint32_t address);
     uint32_t readMemory32(uint32_t address);
@@ -106,10 +150,17 @@ struct System {
     std::string biosPath;
     int biosLog = 0;
     bool printStackTrace = false;
+    void mapMemory();
+    void protectRamPage(uint32_t page, bool protect);
+    // RAM range was written directly (bypassing writeMemory) - drops compiled code on touched pages, range can wrap around RAM end
+    void ramWritten(uint32_t address, uint32_t size);
+    void setFastmem(bool enabled);
+    void setHle(const std::unordered_map<std::string, bool>& options);
     bool loadBios(const std::string& name);
     bool loadExpansion(const std::vector<uint8_t>& _exe);
     bool loadExeFile(const std::vector<uint8_t>& _exe);
     void dumpRam();
+    void toast(const std::string& message);
 
 #ifdef ENABLE_IO_LOG
     struct IO_LOG_ENTRY {
@@ -141,5 +192,9 @@ struct System {
 
         ar(ram);
         ar(scratchpad);
+
+        ar(cycles, spuCycles);
+        ar(*scheduler);
+        ar(hleHeap);
     }
 };
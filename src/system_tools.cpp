@@ -1,8 +1,8 @@
 #include "system_tools.h"
 #include <fmt/core.h>
+#include "bios/hle.h"
 #include "config.h"
 #include "disc/load.h"
-#include "sound/sound.h"
 #include "state/state.h"
 #include "system.h"
 #include "utils/file.h"
@@ -11,19 +11,63 @@
 
 namespace system_tools {
 
+namespace {
+// Booted system depends only on BIOS image and config used during boot, FNV-1a of both names the snapshot
+std::string bootSnapshotPath(System* sys) {
+    uint64_t hash = 0xcbf29ce484222325;
+    auto add = [&](const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 0x100000001b3;
+        }
+    };
+
+    const auto& config = sys->config;
+    std::string options = fmt::format("ntsc={}", config.options.graphics.forceNtsc);
+    for (const auto& option : bios::hle::options()) {
+        auto hle = config.options.emulator.hle.find(option);
+        if (hle != config.options.emulator.hle.end() && hle->second) options += "," + option;
+    }
+
+    add(sys->bios.data(), sys->bios.size());
+    add(reinterpret_cast<const uint8_t*>(options.data()), options.size());
+
+    return avocado::statePath(fmt::format("boot_{:016x}.state", hash).c_str());
+}
+}  // namespace
+
 void bootstrap(std::unique_ptr<System>& sys) {
-    Sound::clearBuffer();
-    sys = std::make_unique<System>();
-    sys->loadBios(config.bios);
+    auto audioSink = sys->audioSink;
+    sys = std::make_unique<System>(sys->config, sys->bus);
+    if (audioSink) audioSink->clear();
+    sys->audioSink = std::move(audioSink);
+    sys->loadBios(sys->config.bios);
+    if (!sys->biosLoaded) return;
+
+    // Restore system stopped at shell entry saved by previous boot
+    std::string snapshot = bootSnapshotPath(sys.get());
+    if (fileExists(snapshot)) {
+        if (state::loadFromFile(sys.get(), snapshot)) {
+            sys->state = System::State::pause;
+            return;
+        }
+
+        // Incompatible snapshot (older save state version) - boot from scratch and replace it
+        sys = std::make_unique<System>(sys->config, sys->bus);
+        sys->loadBios(sys->config.bios);
+    }
 
     // Breakpoint on BIOS Shell execution
     sys->cpu->addBreakpoint(0x80030000);
 
     // Execute BIOS till breakpoint hit (shell is about to be executed)
     while (sys->state == System::State::run) sys->emulateFrame();
+
+    if (sys->state == System::State::pause && !state::saveToFile(sys.get(), snapshot)) {
+        fmt::print("[INFO] Cannot save boot snapshot to {}\n", snapshot);
+    }
 }
 
-void loadFile(std::unique_ptr<System>& sys, const std::string& path) {
+bool loadFile(std::unique_ptr<System>& sys, const std::string& path) {
     std::string ext = getExtension(path);
     transform(ext.begin(), ext.end(), ext.begin(), tolower);
 
@@ -32,34 +76,36 @@ void loadFile(std::unique_ptr<System>& sys, const std::string& path) {
 
     if (ext == "psf" || ext == "minipsf") {
         bootstrap(sys);
-        if (loadPsf(sys.get(), path)) {
-            toast(fmt::format("{} loaded", filenameExt));
+        bool loaded = loadPsf(sys.get(), path);
+        if (loaded) {
+            sys->toast(fmt::format("{} loaded", filenameExt));
         } else {
-            toast(fmt::format("Cannot load {}", filenameExt));
+            sys->toast(fmt::format("Cannot load {}", filenameExt));
         }
         sys->state = System::State::run;
-        return;
+        return loaded;
     }
 
     if (ext == "exe" || ext == "psexe") {
         bool isPaused = sys->state == System::State::pause;
         bootstrap(sys);
         // Replace shell with .exe contents
-        if (sys->loadExeFile(getFileContents(path))) {
-            toast(fmt::format("{} loaded", filenameExt));
+        bool loaded = sys->loadExeFile(getFileContents(path));
+        if (loaded) {
+            sys->toast(fmt::format("{} loaded", filenameExt));
         } else {
-            toast(fmt::format("Cannot load {}", filenameExt));
+            sys->toast(fmt::format("Cannot load {}", filenameExt));
         }
 
         // Resume execution
         sys->state = isPaused ? System::State::pause : System::State::run;
-        return;
+        return loaded;
     }
 
     if (ext == "state") {
         if (state::loadFromFile(sys.get(), path)) {
             sys->state = System::State::pause;
-            return;
+            return true;
         }
     }
 
@@ -67,27 +113,28 @@ void loadFile(std::unique_ptr<System>& sys, const std::string& path) {
         if (GpuDrawList::load(sys.get(), path)) {
             sys->state = System::State::pause;
             GpuDrawList::replayCommands(sys->gpu.get());
-            toast(fmt::format("{} loaded", filenameExt));
-            bus.notify(Event::Gui::Debug::OpenDrawListWindows{});
-            return;
+            sys->toast(fmt::format("{} loaded", filenameExt));
+            sys->bus->notify(Event::Gui::Debug::OpenDrawListWindows{});
+            return true;
         }
     }
 
     std::unique_ptr<disc::Disc> disc = disc::load(path);
-    if (disc) {
-        sys->cdrom->disc = std::move(disc);
-        sys->cdrom->setShell(false);
-        toast(fmt::format("{} loaded", filenameExt));
-    } else {
-        toast(fmt::format("Cannot load {}", filenameExt));
+    if (!disc) {
+        sys->toast(fmt::format("Cannot load {}", filenameExt));
+        return false;
     }
+    sys->cdrom->disc = std::move(disc);
+    sys->cdrom->setShell(false);
+    sys->toast(fmt::format("{} loaded", filenameExt));
+    return true;
 }
 
 void saveMemoryCards(std::unique_ptr<System>& sys, bool force) {
     auto saveMemoryCard = [&](int slot) {
         if (!force && !sys->controller->card[slot]->dirty) return;
 
-        std::string pathCard = config.memoryCard[slot].path;
+        std::string pathCard = sys->config.memoryCard[slot].path;
 
         if (pathCard.empty()) {
             fmt::print("[INFO] No memory card {} path in config, skipping save\n", slot + 1);
@@ -109,8 +156,10 @@ void saveMemoryCards(std::unique_ptr<System>& sys, bool force) {
     saveMemoryCard(1);
 }
 
-std::unique_ptr<System> hardReset() {
-    auto sys = std::make_unique<System>();
+std::unique_ptr<System> hardReset(const avocado_config_t& config, std::shared_ptr<Dexode::EventBus> bus,
+                                  std::shared_ptr<AudioSink> audioSink) {
+    auto sys = std::make_unique<System>(config, std::move(bus));
+    sys->audioSink = std::move(audioSink);
 
     std::string bios = config.bios;
     if (!bios.empty() && sys->loadBios(bios)) {
@@ -132,7 +181,7 @@ std::unique_ptr<System> hardReset() {
         assert(slot == 0 || slot == 1);
         auto card = sys->controller->card[slot].get();
 
-        std::string pathCard = config.memoryCard[slot].path;
+        std::string pathCard = sys->config.memoryCard[slot].path;
 
         card->inserted = false;
 
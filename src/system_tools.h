@@ -1,14 +1,19 @@
 #pragma once
 #include <memory>
 #include <string>
+#include "config.h"
 
+struct AudioSink;
 struct System;
 
 namespace system_tools {
 
+// Runs BIOS until shell entry, system booted with the same BIOS and config is restored from snapshot
 void bootstrap(std::unique_ptr<System>& sys);
-void loadFile(std::unique_ptr<System>& sys, const std::string& path);
+// Returns false when file couldn't be loaded (reported with toast as well)
+bool loadFile(std::unique_ptr<System>& sys, const std::string& path);
 void saveMemoryCards(std::unique_ptr<System>& sys, bool force = false);
-std::unique_ptr<System> hardReset();
+std::unique_ptr<System> hardReset(const avocado_config_t& config, std::shared_ptr<Dexode::EventBus> bus,
+                                  std::shared_ptr<AudioSink> audioSink = nullptr);
 
 };  // namespace system_tools
\ No newline at end of file
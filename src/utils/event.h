@@ -10,6 +10,7 @@ struct Graphics {};
 struct Gte {};
 struct Controller {};
 struct Spu {};
+struct Cpu {};
 };  // namespace Config
 
 namespace File {
@@ -2,9 +2,6 @@
 #include <cstdio>
 
 namespace GpuDrawList {
-int framesToCapture = 0;
-int currentFrame = 0;
-
 bool load(System *sys, const std::string &path) {
     FILE *f = fopen(path.c_str(), "rb");
     if (!f) {
@@ -69,8 +66,10 @@ bool save(System *sys, const std::string &path) {
 }
 
 void replayCommands(gpu::GPU *gpu, int to) {
+    gpu->flushDeferred();
     gpu->vram = gpu->prevVram;
 
+    bool logEnabled = gpu->gpuLogEnabled;
     gpu->gpuLogEnabled = false;
     if (to == -1) to = gpu->gpuLogList.size() - 1;
     for (int i = 0; i <= to; i++) {
@@ -86,7 +85,8 @@ void replayCommands(gpu::GPU *gpu, int to) {
             gpu->write(addr, arg);
         }
     }
-    gpu->gpuLogEnabled = true;
+    gpu->flushDeferred();
+    gpu->gpuLogEnabled = logEnabled;
 }
 
 void dumpInitialState(gpu::GPU *gpu) {
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/*
+Host time spent in emulated subsystems.
+Time is exclusive - entering a section pauses the one it was entered from
+(GPU command executed by DMA is charged to GPU, not to DMA).
+Everything outside of entered sections is charged to CPU.
+Disabled by default, costs a single branch per section then.
+*/
+class Profiler {
+   public:
+    enum class Section { cpu, gpu, spu, cdrom, timers, dma, controller, COUNT };
+    static const size_t SECTION_COUNT = (size_t)Section::COUNT;
+
+    class Scope {
+        Profiler& profiler;
+        Section previous;
+
+       public:
+        Scope(Profiler& profiler, Section section) : profiler(profiler), previous(profiler.current) {
+            if (profiler.enabled) profiler.switchTo(section);
+        }
+        ~Scope() {
+            if (profiler.enabled) profiler.switchTo(previous);
+        }
+    };
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    bool enabled = false;
+    Section current = Section::cpu;
+    Clock::time_point start;
+    std::array<Clock::duration, SECTION_COUNT> total{};
+
+    void switchTo(Section section) {
+        auto now = Clock::now();
+        total[(size_t)current] += now - start;
+        start = now;
+        current = section;
+    }
+
+   public:
+    bool isEnabled() const { return enabled; }
+
+    void enable() {
+        enabled = true;
+        current = Section::cpu;
+        start = Clock::now();
+    }
+
+    void disable() {
+        if (enabled) switchTo(Section::cpu);
+        enabled = false;
+    }
+
+    void reset() { total.fill({}); }
+
+    std::chrono::nanoseconds get(Section section) const { return total[(size_t)section]; }
+
+    static const char* name(Section section) {
+        static const char* names[] = {"cpu", "gpu", "spu", "cdrom", "timers", "dma", "controller"};
+        return names[(size_t)section];
+    }
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Lock-free bounded queue for exactly one producer and one consumer thread
+template <class T, size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "Queue size must be power of two");
+
+    std::array<T, N> items{};
+    std::atomic<size_t> head{0};  // Next item to pop, written by consumer
+    std::atomic<size_t> tail{0};  // Next free slot, written by producer
+
+   public:
+    // Returns false if queue is full
+    bool push(T item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        items[t % N] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if queue is empty
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(items[h % N]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pushes as many items as fit, returns their count
+    size_t push(const T* data, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        count = std::min(count, N - (t - head.load(std::memory_order_acquire)));
+        for (size_t i = 0; i < count; i++) items[(t + i) % N] = data[i];
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Pops up to count items, returns number of popped ones
+    size_t pop(T* data, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        count = std::min(count, tail.load(std::memory_order_acquire) - h);
+        for (size_t i = 0; i < count; i++) data[i] = std::move(items[(h + i) % N]);
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+Lock-free single producer, single consumer handoff of the newest value.
+Producer fills writeBuffer() and publishes it, consumer picks up the most recent
+published buffer - neither side ever waits, older unread values are overwritten.
+*/
+template <class T>
+class TripleBuffer {
+    static const uint8_t INDEX = 3;
+    static const uint8_t DIRTY = 4;  // Shared buffer holds value not seen by consumer yet
+
+    std::array<T, 3> buffers{};
+    std::atomic<uint8_t> shared{1};
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 2;
+
+   public:
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() { writeIndex = shared.exchange(writeIndex | DIRTY, std::memory_order_acq_rel) & INDEX; }
+
+    bool hasUpdate() const { return shared.load(std::memory_order_relaxed) & DIRTY; }
+
+    // Returns false if nothing new was published since last call
+    bool update() {
+        if (!(shared.load(std::memory_order_relaxed) & DIRTY)) return false;
+        readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+};
@@ -0,0 +1,250 @@
+#include "bios/hle.h"
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include "system.h"
+
+// Differential test - every scenario is executed by real BIOS code and by native routines,
+// results and guest memory have to match.
+// BIOS image is taken from AVOCADO_BIOS environment variable (default data/bios/scph1001.bin),
+// tests are skipped when it's missing.
+namespace bios::hle {
+
+namespace {
+const uint32_t RETURN_ADDRESS = 0x800f'f000;
+const uint32_t BUFFER = 0x8010'0000;
+const uint32_t BUFFER_SIZE = 0x1'0000;
+const int INSTRUCTION_LIMIT = 10'000'000;
+
+class Bios {
+    std::unique_ptr<System> sys;
+    std::array<uint8_t, System::RAM_SIZE> initialRam;
+
+   public:
+    bool native = false;
+
+    bool boot() {
+        const char* path = std::getenv("AVOCADO_BIOS");
+        sys = std::make_unique<System>();
+        if (!sys->loadBios(path != nullptr ? path : "data/bios/scph1001.bin")) return false;
+
+        sys->cpu->setMode(CpuMode::interpreter);
+        sys->cpu->addBreakpoint(0x80030000);
+        while (sys->state == System::State::run) sys->emulateFrame();
+
+        sys->debugOutput = false;
+        sys->biosLog = 0;
+        initialRam = sys->ram;
+        return true;
+    }
+
+    // Every scenario starts from state right after kernel initialization
+    void reset(bool native) {
+        this->native = native;
+        sys->ram = initialRam;
+        sys->hleHeap = Heap();
+
+        std::unordered_map<std::string, bool> enabled;
+        for (const auto& option : options()) enabled[option] = native;
+        sys->setHle(enabled);
+    }
+
+    void prepare(uint8_t function, std::initializer_list<uint32_t> args) {
+        auto cpu = sys->cpu.get();
+        int n = 0;
+        for (auto arg : args) cpu->reg[4 + n++] = arg;
+        cpu->reg[9] = function;
+        cpu->reg[31] = RETURN_ADDRESS;
+        cpu->setPC(0xa0);
+
+        // Devices are not stepped - no interrupt can interfere
+        cpu->cop0.status.interruptEnable = false;
+        cpu->updateInterruptPending();
+        sys->state = System::State::run;
+    }
+
+    uint32_t call(uint8_t function, std::initializer_list<uint32_t> args = {}) {
+        auto cpu = sys->cpu.get();
+        prepare(function, args);
+        if (native) {
+            REQUIRE(sys->handleBiosFunction());
+        } else {
+            for (int i = 0; i < INSTRUCTION_LIMIT && cpu->PC != RETURN_ADDRESS; i++) cpu->executeInstructions(1);
+        }
+        REQUIRE(cpu->PC == RETURN_ADDRESS);
+        return cpu->reg[2];
+    }
+
+    void write(uint32_t address, const std::string& data) {
+        for (size_t i = 0; i < data.size(); i++) sys->writeMemory8(address + i, data[i]);
+        sys->writeMemory8(address + data.size(), 0);
+    }
+
+    // Native routine handled the call, CPU is left at BIOS entry (not in exception handler) otherwise
+    bool handledNatively(uint8_t function, std::initializer_list<uint32_t> args) {
+        prepare(function, args);
+        bool handled = sys->handleBiosFunction();
+        if (!handled) REQUIRE(sys->cpu->PC == 0xa0);
+        return handled;
+    }
+
+    uint8_t read(uint32_t address) { return sys->readMemory8(address); }
+
+    std::vector<uint8_t> buffer() {
+        std::vector<uint8_t> data(BUFFER_SIZE);
+        for (uint32_t i = 0; i < BUFFER_SIZE; i++) data[i] = read(BUFFER + i);
+        return data;
+    }
+};
+
+Bios* bios() {
+    static std::unique_ptr<Bios> instance;
+    static bool available = false;
+    if (!instance) {
+        instance = std::make_unique<Bios>();
+        available = instance->boot();
+    }
+    return available ? instance.get() : nullptr;
+}
+
+// Runs scenario on BIOS and natively, compares returned values and buffer contents
+void compare(const std::function<std::vector<uint32_t>(Bios&)>& scenario) {
+    Bios* b = bios();
+    if (b == nullptr) {
+        WARN("BIOS image not found, skipping");
+        return;
+    }
+
+    b->reset(false);
+    auto expected = scenario(*b);
+    auto expectedBuffer = b->buffer();
+
+    b->reset(true);
+    auto result = scenario(*b);
+    REQUIRE(result == expected);
+    REQUIRE(b->buffer() == expectedBuffer);
+}
+
+const std::string TEXT = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+}  // namespace
+
+TEST_CASE("memcpy matches BIOS", "[hle]") {
+    compare([](Bios& b) {
+        b.write(BUFFER, TEXT);
+        std::vector<uint32_t> results;
+        for (uint32_t length : {0u, 1u, 3u, 17u, 56u}) results.push_back(b.call(0x2A, {BUFFER + 0x100 + length * 64, BUFFER, length}));
+        results.push_back(b.call(0x2A, {BUFFER + 1, BUFFER, 16}));  // Overlapping
+        results.push_back(b.call(0x2A, {0, BUFFER, 16}));
+        results.push_back(b.call(0x2A, {BUFFER + 0x1000, BUFFER, 0x8000'0000}));
+        return results;
+    });
+}
+
+TEST_CASE("memset and bzero match BIOS", "[hle]") {
+    compare([](Bios& b) {
+        std::vector<uint32_t> results;
+        for (uint32_t length : {0u, 1u, 5u, 100u}) results.push_back(b.call(0x2B, {BUFFER + length * 128, 0x1a5, length}));
+        results.push_back(b.call(0x2B, {0, 0xff, 16}));
+        results.push_back(b.call(0x2B, {BUFFER, 0xff, 0xffff'ffff}));
+
+        b.write(BUFFER + 0x1000, TEXT);
+        for (uint32_t length : {0u, 1u, 7u}) results.push_back(b.call(0x28, {BUFFER + 0x1000 + length * 8, length}));
+        results.push_back(b.call(0x28, {0, 16}));
+        results.push_back(b.call(0x28, {BUFFER + 0x1000, 0x8000'0000}));
+        return results;
+    });
+}
+
+TEST_CASE("String functions match BIOS", "[hle]") {
+    compare([](Bios& b) {
+        const uint32_t s1 = BUFFER, s2 = BUFFER + 0x100, dst = BUFFER + 0x200;
+        std::vector<uint32_t> results;
+
+        for (auto [a, c] : std::initializer_list<std::pair<std::string, std::string>>{
+                 {"", ""}, {"hello", "hello"}, {"hello", "hellp"}, {"hell", "hello"}, {"b", "a"}, {"\x80", "a"}}) {
+            b.write(s1, a);
+            b.write(s2, c);
+            results.push_back(b.call(0x17, {s1, s2}));
+            results.push_back(b.call(0x1B, {s1}));
+            results.push_back(b.call(0x19, {dst, s2}));
+        }
+        results.push_back(b.call(0x17, {0, 0}));
+        results.push_back(b.call(0x17, {0, s1}));
+        results.push_back(b.call(0x17, {s1, 0}));
+        results.push_back(b.call(0x1B, {0}));
+        results.push_back(b.call(0x19, {0, s1}));
+        results.push_back(b.call(0x19, {dst, 0}));
+        return results;
+    });
+}
+
+TEST_CASE("rand matches BIOS", "[hle]") {
+    compare([](Bios& b) {
+        std::vector<uint32_t> results;
+        for (int i = 0; i < 4; i++) results.push_back(b.call(0x2F));
+        b.call(0x30, {0x1234'5678});
+        for (int i = 0; i < 4; i++) results.push_back(b.call(0x2F));
+        return results;
+    });
+}
+
+// Heap layout is implementation specific - only allocation results and contents are compared
+TEST_CASE("malloc family behaves as BIOS", "[hle]") {
+    const uint32_t heap = BUFFER + BUFFER_SIZE, heapSize = 0x1000;
+    compare([=](Bios& b) {
+        std::vector<uint32_t> results;
+        auto valid = [&](uint32_t ptr, uint32_t size) {
+            results.push_back(ptr != 0);
+            if (ptr != 0) {
+                REQUIRE(ptr >= heap);
+                REQUIRE(ptr + size <= heap + heapSize);
+            }
+        };
+
+        b.call(0x39, {heap, heapSize});
+        uint32_t a = b.call(0x33, {16});
+        valid(a, 16);
+        uint32_t c = b.call(0x37, {4, 8});
+        valid(c, 32);
+        for (uint32_t i = 0; i < 32; i++) results.push_back(b.read(c + i));
+        REQUIRE((a + 16 <= c || c + 32 <= a));
+
+        b.write(a, "0123456789abcde");
+        uint32_t d = b.call(0x38, {a, 200});
+        valid(d, 200);
+        for (uint32_t i = 0; i < 16; i++) results.push_back(b.read(d + i));
+
+        b.call(0x34, {d});
+        valid(b.call(0x33, {0x800}), 0x800);
+        results.push_back(b.call(0x33, {0x10000}));
+        return results;
+    });
+}
+
+TEST_CASE("Routines touching memory outside RAM fall back to BIOS", "[hle]") {
+    Bios* b = bios();
+    if (b == nullptr) {
+        WARN("BIOS image not found, skipping");
+        return;
+    }
+    b->reset(true);
+
+    const uint32_t UNMAPPED = 0x0f00'0000;
+    const uint32_t RAM_END = 0x8000'0000 + System::RAM_SIZE;
+    b->write(BUFFER, TEXT);
+    REQUIRE_FALSE(b->handledNatively(0x2A, {UNMAPPED, BUFFER, 16}));
+    REQUIRE_FALSE(b->handledNatively(0x2A, {BUFFER, UNMAPPED, 16}));
+    REQUIRE_FALSE(b->handledNatively(0x2A, {RAM_END - 8, BUFFER, 16}));  // Continues in next mirror
+    REQUIRE_FALSE(b->handledNatively(0x2B, {UNMAPPED, 0, 16}));
+    REQUIRE_FALSE(b->handledNatively(0x28, {UNMAPPED, 16}));
+    REQUIRE_FALSE(b->handledNatively(0x17, {UNMAPPED, BUFFER}));
+    REQUIRE_FALSE(b->handledNatively(0x1B, {UNMAPPED}));
+    REQUIRE_FALSE(b->handledNatively(0x19, {UNMAPPED, BUFFER}));
+    REQUIRE_FALSE(b->handledNatively(0x39, {UNMAPPED, 0x1000}));
+
+    REQUIRE(b->handledNatively(0x2A, {UNMAPPED, UNMAPPED, 0}));  // Nothing is accessed
+}
+
+}  // namespace bios::hle
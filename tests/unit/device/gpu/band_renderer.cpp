@@ -0,0 +1,203 @@
+#include "device/gpu/band_renderer.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Queues are drawn serially with Entry::draw (as GPU does without renderer threads) and by BandRenderer,
+// VRAM and palette cache left after every batch have to be identical.
+namespace gpu {
+
+namespace {
+struct Random {
+    uint32_t state;
+    int operator()(int n) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (int)(state % n);
+    }
+};
+
+// Same areas GPU records for queued primitives
+Rect<int> textureArea(ivec2 texpage, int bits) {
+    if (bits == 0) return {};
+    int width = bits == 4 ? 64 : (bits == 8 ? 128 : 256);
+    if (texpage.x + width > VRAM_WIDTH) return {0, texpage.y, VRAM_WIDTH, std::min(texpage.y + 256, VRAM_HEIGHT)};
+    return {texpage.x, texpage.y, texpage.x + width, std::min(texpage.y + 256, VRAM_HEIGHT)};
+}
+
+Rect<int> clutArea(ivec2 clut, int bits) {
+    if (bits != 4 && bits != 8) return {};
+    int entries = bits == 8 ? 256 : 16;
+    if (clut.x + entries > VRAM_WIDTH) return {0, clut.y, VRAM_WIDTH, std::min(clut.y + 2, VRAM_HEIGHT)};
+    return {clut.x, clut.y, clut.x + entries, clut.y + 1};
+}
+
+Rect<int> drawingBounds(const Rect<int16_t>& area, int left, int top, int right, int bottom) {
+    return {
+        std::max({left, (int)area.left, 0}),
+        std::max({top, (int)area.top, 0}),
+        std::min({right + 1, area.right + 1, VRAM_WIDTH}),
+        std::min({bottom + 1, area.bottom + 1, VRAM_HEIGHT}),
+    };
+}
+
+int randomBits(Random& random) {
+    const int bits[] = {0, 4, 8, 16};
+    return bits[random(4)];
+}
+
+// Texture page either anywhere or under the primitive itself (sampling its own output)
+ivec2 randomTexpage(Random& random, ivec2 pos) {
+    if (random(8) == 0) return ivec2(std::clamp(pos.x, 0, VRAM_WIDTH - 1) & ~63, pos.y >= 256 ? 256 : 0);
+    return ivec2(random(16) * 64, random(2) * 256);
+}
+
+// Last line is left out - palette crossing the right edge continues in the next line, past the end of VRAM there
+ivec2 randomClut(Random& random, ivec2 pos) {
+    if (random(8) == 0) return ivec2(std::clamp(pos.x, 0, VRAM_WIDTH - 16) & ~15, std::clamp(pos.y, 0, VRAM_HEIGHT - 2));
+    return ivec2(random(64) * 16, random(VRAM_HEIGHT - 1));
+}
+
+DrawQueue::Entry randomEntry(Random& random) {
+    GP0_E1 e1;
+    e1.semiTransparency = (SemiTransparency)random(4);
+    e1.dither24to15 = random(2);
+    GP0_E2 e2;
+    if (random(4) == 0) e2._reg = (uint32_t)random(1 << 20);
+    GP0_E6 e6;
+    e6.setMaskWhileDrawing = random(4) == 0;
+    e6.checkMaskBeforeDraw = random(4) == 0;
+    Rect<int16_t> area{0, 0, VRAM_WIDTH - 1, VRAM_HEIGHT - 1};
+    if (random(4) == 0) {
+        area.left = (int16_t)random(512);
+        area.top = (int16_t)random(256);
+        area.right = (int16_t)(area.left + random(512));
+        area.bottom = (int16_t)(area.top + random(256));
+    }
+
+    const ivec2 origin(random(VRAM_WIDTH + 32) - 16, random(VRAM_HEIGHT + 32) - 16);
+    const bool semiTransparent = random(3) == 0;
+    DrawQueue::Entry entry;
+    switch (random(3)) {
+        case 0: {
+            primitive::Triangle t;
+            for (auto& v : t.v) {
+                v.pos = origin + ivec2(random(161) - 80, random(161) - 80);
+                v.color = RGB(random(256), random(256), random(256));
+                v.uv = ivec2(random(256), random(256));
+            }
+            t.bits = randomBits(random);
+            t.isSemiTransparent = semiTransparent;
+            t.transparency = (SemiTransparency)random(4);
+            t.isRawTexture = random(2);
+            t.gouraudShading = random(2);
+            t.texpage = randomTexpage(random, origin);
+            t.clut = randomClut(random, origin);
+            t.assureCcw();
+
+            entry = DrawQueue::Entry{t, e1, e2, e6, area};
+            entry.bounds = drawingBounds(area, std::min({t.v[0].pos.x, t.v[1].pos.x, t.v[2].pos.x}),
+                                         std::min({t.v[0].pos.y, t.v[1].pos.y, t.v[2].pos.y}),
+                                         std::max({t.v[0].pos.x, t.v[1].pos.x, t.v[2].pos.x}),
+                                         std::max({t.v[0].pos.y, t.v[1].pos.y, t.v[2].pos.y}));
+            entry.texture = textureArea(t.texpage, t.bits);
+            entry.clut = clutArea(t.clut, t.bits);
+            break;
+        }
+        case 1: {
+            primitive::Line l;
+            l.pos[0] = origin;
+            l.pos[1] = origin + ivec2(random(401) - 200, random(401) - 200);
+            l.color[0] = RGB(random(256), random(256), random(256));
+            l.color[1] = RGB(random(256), random(256), random(256));
+            l.isSemiTransparent = semiTransparent;
+            l.gouraudShading = random(2);
+
+            entry = DrawQueue::Entry{l, e1, e2, e6, area};
+            entry.bounds = drawingBounds(area, std::min(l.pos[0].x, l.pos[1].x), std::min(l.pos[0].y, l.pos[1].y),
+                                         std::max(l.pos[0].x, l.pos[1].x), std::max(l.pos[0].y, l.pos[1].y));
+            break;
+        }
+        default: {
+            primitive::Rect r;
+            r.pos = origin;
+            r.size = ivec2(1 + random(128), 1 + random(128));
+            r.color = RGB(random(256), random(256), random(256));
+            r.bits = randomBits(random);
+            r.isSemiTransparent = semiTransparent;
+            r.isRawTexture = random(2);
+            r.uv = ivec2(random(256), random(256));
+            r.texpage = randomTexpage(random, origin);
+            r.clut = randomClut(random, origin);
+
+            entry = DrawQueue::Entry{r, e1, e2, e6, area};
+            entry.bounds = drawingBounds(area, r.pos.x, r.pos.y, r.pos.x + r.size.x - 1, r.pos.y + r.size.y - 1);
+            entry.texture = textureArea(r.texpage, r.bits);
+            entry.clut = clutArea(r.clut, r.bits);
+            break;
+        }
+    }
+    entry.readsDestination = semiTransparent || e6.checkMaskBeforeDraw;
+    return entry;
+}
+
+// Only loaded entries are meaningful, the rest depends on how many palettes were loaded on the way
+bool samePalette(const ClutCache& a, const ClutCache& b) {
+    if (a.pos != b.pos || a.colorDepth != b.colorDepth) return false;
+    if (a.pos == ivec2(-1, -1)) return true;
+    const int count = a.colorDepth == ColorDepth::BIT_8 ? 256 : 16;
+    return std::equal(a.entries.begin(), a.entries.begin() + count, b.entries.begin());
+}
+
+struct Vram {
+    // Padded as GPU::vram (32bit texture gathers)
+    std::vector<uint16_t> pixels = std::vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT + 1);
+    ClutCache clut;
+};
+}  // namespace
+
+TEST_CASE("Band rendering matches serial drawing", "[band_renderer]") {
+    const uint32_t seed = GENERATE(0x1234u, 0xbeefu, 0xcafeu);
+    Random random{seed};
+
+    Vram serial, banded;
+    for (auto& pixel : serial.pixels) pixel = (uint16_t)random(0x10000);  // Random mask bits as well
+    banded = serial;
+
+    BandRenderer renderer(4);
+    DrawQueue queue;
+    int batches = 0;
+    auto flush = [&]() {
+        for (const auto& entry : queue.getEntries()) {
+            if (entry.invalidateClut) serial.clut.invalidate();
+            entry.draw(serial.pixels.data(), serial.clut);
+        }
+        renderer.draw(queue, banded.pixels.data(), banded.clut);
+        if (queue.isClutInvalidationPending()) {
+            serial.clut.invalidate();
+            banded.clut.invalidate();
+        }
+        queue.clear();
+        batches++;
+
+        const auto mismatch = std::mismatch(serial.pixels.begin(), serial.pixels.end(), banded.pixels.begin()).first;
+        const int offset = (int)(mismatch - serial.pixels.begin());
+        INFO("seed " << seed << " batch " << batches << " pixel " << offset % VRAM_WIDTH << "," << offset / VRAM_WIDTH);
+        REQUIRE(mismatch == serial.pixels.end());
+        REQUIRE(samePalette(serial.clut, banded.clut));
+    };
+
+    for (int i = 0; i < 3000; i++) {
+        auto entry = randomEntry(random);
+        // GPU draws the queue when primitive would sample pixels written in the same batch
+        if (queue.samplingConflicts(entry)) flush();
+        if (random(16) == 0) queue.invalidateClut();
+        queue.push(std::move(entry));
+        if (random(64) == 0) flush();
+    }
+    flush();
+}
+
+}  // namespace gpu
@@ -0,0 +1,225 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "device/gpu/render/render.h"
+
+// Triangle attribute interpolation tests.
+// Golden hashes are regression values captured from the fixed point rasterizer itself (not from hardware),
+// they catch unintended changes and keep scalar and AVX2 paths producing the same images.
+#ifdef USE_FIXED_POINT
+namespace {
+struct Canvas {
+    // AVX2 gathers read 32bit words, last pixel needs padding after it (as GPU::vramPadding)
+    std::vector<uint16_t> vram = std::vector<uint16_t>(gpu::VRAM_WIDTH * gpu::VRAM_HEIGHT + 1);
+    gpu::ClutCache clut;
+    Render::Target target{vram.data(), {}, {}, {}, {}, &clut};
+
+    Canvas() {
+        target.drawingArea.right = gpu::VRAM_WIDTH - 1;
+        target.drawingArea.bottom = gpu::VRAM_HEIGHT - 1;
+    }
+
+    uint16_t& at(int x, int y) { return vram[y * gpu::VRAM_WIDTH + x]; }
+
+    void draw(primitive::Triangle triangle) {
+        triangle.assureCcw();
+        Render::drawTriangle(target, triangle);
+    }
+
+    uint64_t hash() const {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (size_t i = 0; i < gpu::VRAM_WIDTH * gpu::VRAM_HEIGHT; i++) hash = (hash ^ vram[i]) * 0x100000001b3;
+        return hash;
+    }
+};
+
+struct Random {
+    uint32_t state;
+    int operator()(int n) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (int)(state % n);
+    }
+};
+
+// Attribute value at pixel - reference model of rounding rules the rasterizer implements, evaluated per pixel
+// without incremental stepping. It's not derived from hardware, only checks that stepping doesn't drift from them.
+int interpolate(const primitive::Triangle& t, const int a[3], int x, int y) {
+    const ivec2 p[3] = {t.v[0].pos, t.v[1].pos, t.v[2].pos};
+    const int64_t area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    const int64_t reciprocal = (int64_t(1) << 44) / area;
+    const int64_t dx = (p[1].y - p[2].y) * a[0] + (p[2].y - p[0].y) * a[1] + (p[0].y - p[1].y) * a[2];
+    const int64_t dy = (p[2].x - p[1].x) * a[0] + (p[0].x - p[2].x) * a[1] + (p[1].x - p[0].x) * a[2];
+    const uint32_t gradientX = (uint32_t)((reciprocal * dx + 0xffffffff) >> 32) << 12;
+    const uint32_t gradientY = (uint32_t)((reciprocal * dy + 0xffffffff) >> 32) << 12;
+
+    // Leftmost of submitted vertices (t is not reordered by assureCcw here), the latter one on tie
+    int core = 0;
+    if (p[1].x <= p[0].x) {
+        core = p[2].x <= p[1].x ? 2 : 1;
+    } else if (p[2].x < p[0].x) {
+        core = 2;
+    }
+
+    uint32_t value = ((uint32_t)a[core] << 24) + (1 << 23);
+    value += gradientX * (uint32_t)(x - p[core].x) + gradientY * (uint32_t)(y - p[core].y);
+    return value >> 24;
+}
+
+// Edge functions with top-left fill rule evaluated directly at the pixel, triangle has to be counter clockwise
+bool covers(const primitive::Triangle& t, int x, int y) {
+    int w[3];
+    for (int i = 0; i < 3; i++) {
+        const ivec2 a = t.v[(i + 1) % 3].pos, b = t.v[(i + 2) % 3].pos;
+        const bool topLeft = a.y - b.y < 0 || (a.y == b.y && b.x - a.x < 0);
+        w[i] = (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x) - (topLeft ? 1 : 0);
+    }
+    return (w[0] | w[1] | w[2]) > 0;
+}
+
+// Raw 15bit texture at (512, 256), every texel stores its own coordinates
+const ivec2 TEXPAGE(512, 256);
+uint16_t texel(int u, int v) { return 0x8000 | u | ((v & 0x7f) << 8); }
+
+primitive::Triangle randomTriangle(Random& random, int bits) {
+    primitive::Triangle t;
+    for (auto& v : t.v) {
+        v.pos = ivec2(random(560) - 24, random(300) - 22);
+        v.color = RGB(random(256), random(256), random(256));
+        v.uv = ivec2(random(256), random(256));
+    }
+    t.bits = bits;
+    t.gouraudShading = true;
+    t.texpage = ivec2(random(8) * 64, 256);
+    t.clut = ivec2(random(16) * 16, 500 + random(12));
+    return t;
+}
+
+uint64_t drawScene(uint32_t seed, int bits, bool dithering, bool semiTransparent) {
+    Canvas canvas;
+    Random random{seed};
+    for (int y = 256; y < gpu::VRAM_HEIGHT; y++) {
+        for (int x = 0; x < gpu::VRAM_WIDTH; x++) canvas.at(x, y) = (uint16_t)(x * 0x9e37 ^ y * 0x79b9);
+    }
+    canvas.target.gp0_e1.dither24to15 = dithering;
+
+    for (int i = 0; i < 200; i++) {
+        auto t = randomTriangle(random, bits);
+        t.isSemiTransparent = semiTransparent;
+        t.transparency = (gpu::SemiTransparency)random(4);
+        canvas.draw(t);
+    }
+    return canvas.hash();
+}
+}  // namespace
+
+TEST_CASE("Interpolated attributes match per pixel reference", "[render_triangle]") {
+    Canvas canvas;
+    for (int v = 0; v < 256; v++) {
+        for (int u = 0; u < 256; u++) canvas.at(TEXPAGE.x + u, TEXPAGE.y + v) = texel(u, v);
+    }
+
+    Random random{0x1234};
+    for (int i = 0; i < 100; i++) {
+        for (int y = 0; y < 256; y++) {
+            for (int x = 0; x < 512; x++) canvas.at(x, y) = 0;
+        }
+
+        primitive::Triangle t;
+        for (auto& v : t.v) {
+            v.pos = ivec2(random(512), random(256));
+            v.uv = ivec2(random(256), random(128));
+        }
+        t.bits = 16;
+        t.isRawTexture = true;
+        t.texpage = TEXPAGE;
+        canvas.draw(t);
+
+        const int u[3] = {t.v[0].uv.x, t.v[1].uv.x, t.v[2].uv.x};
+        const int v[3] = {t.v[0].uv.y, t.v[1].uv.y, t.v[2].uv.y};
+        for (int y = 0; y < 256; y++) {
+            for (int x = 0; x < 512; x++) {
+                if (canvas.at(x, y) == 0) continue;
+                INFO("triangle " << i << " pixel " << x << "," << y);
+                REQUIRE(canvas.at(x, y) == texel(interpolate(t, u, x, y), interpolate(t, v, x, y) & 0x7f));
+            }
+        }
+    }
+}
+
+TEST_CASE("Texture mapped 1:1 samples every texel once", "[render_triangle]") {
+    Canvas canvas;
+    for (int v = 0; v < 256; v++) {
+        for (int u = 0; u < 256; u++) canvas.at(TEXPAGE.x + u, TEXPAGE.y + v) = texel(u, v);
+    }
+
+    for (int size : {7, 64, 100, 127, 255}) {
+        primitive::Triangle t;
+        t.v[0].pos = ivec2(0, 0), t.v[0].uv = ivec2(0, 0);
+        t.v[1].pos = ivec2(size, 0), t.v[1].uv = ivec2(size, 0);
+        t.v[2].pos = ivec2(0, size), t.v[2].uv = ivec2(0, size);
+        t.bits = 16;
+        t.isRawTexture = true;
+        t.texpage = TEXPAGE;
+        canvas.draw(t);
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size - y; x++) {
+                INFO("size " << size << " pixel " << x << "," << y);
+                REQUIRE(canvas.at(x, y) == texel(x, y));
+            }
+        }
+    }
+}
+
+TEST_CASE("Only covered pixels are drawn", "[render_triangle]") {
+    Canvas canvas;
+    Random random{0x5678};
+
+    SECTION("Thin and large triangles") {
+        for (int i = 0; i < 200; i++) {
+            std::fill(canvas.vram.begin(), canvas.vram.end(), 0);
+
+            primitive::Triangle t;
+            t.v[0].pos = ivec2(random(1024), random(512));
+            t.v[1].pos = ivec2(random(1024), random(512));
+            t.v[2].pos = i % 2 ? t.v[1].pos + ivec2(random(5) - 2, random(5) - 2) : ivec2(random(1024), random(512));
+            for (auto& v : t.v) v.color = RGB(255, 255, 255);
+            t.assureCcw();
+            canvas.draw(t);
+
+            int mismatches = 0;
+            for (int y = 0; y < gpu::VRAM_HEIGHT; y++) {
+                for (int x = 0; x < gpu::VRAM_WIDTH; x++) mismatches += (canvas.at(x, y) != 0) != covers(t, x, y);
+            }
+            INFO("triangle " << i);
+            REQUIRE(mismatches == 0);
+        }
+    }
+
+    SECTION("Drawing area with left edge past the right one") {
+        canvas.target.drawingArea.left = 600;
+        canvas.target.drawingArea.right = 100;
+
+        primitive::Triangle t;
+        t.v[0].pos = ivec2(0, 0);
+        t.v[1].pos = ivec2(1000, 0);
+        t.v[2].pos = ivec2(0, 500);
+        for (auto& v : t.v) v.color = RGB(255, 255, 255);
+        canvas.draw(t);
+
+        REQUIRE(std::all_of(canvas.vram.begin(), canvas.vram.end(), [](uint16_t c) { return c == 0; }));
+    }
+}
+
+TEST_CASE("Golden images", "[render_triangle]") {
+    SECTION("Gouraud") { REQUIRE(drawScene(1, 0, false, false) == 0xd86387de9f8a656e); }
+    SECTION("Gouraud dithered") { REQUIRE(drawScene(2, 0, true, false) == 0x6f7609736a0c8bb0); }
+    SECTION("Gouraud semi-transparent") { REQUIRE(drawScene(3, 0, true, true) == 0x34c84393034c4cb6); }
+    SECTION("Textured 4bit") { REQUIRE(drawScene(4, 4, true, false) == 0x1f1ae218e09b8962); }
+    SECTION("Textured 8bit") { REQUIRE(drawScene(5, 8, true, false) == 0x32b26a170ac6f1d1); }
+    SECTION("Textured 15bit semi-transparent") { REQUIRE(drawScene(6, 16, false, true) == 0xcb45530af86226dc); }
+}
+#endif